@@ -18,10 +18,11 @@
 #define HCSR04_HPP_
 
 #include <Arduino.h>
+#include "hcsr04_air.hpp"
 
 /* ========================= Configuration constants ========================= */
 
-/** @brief Speed of sound (cm/us) at ~20°C, no humidity compensation. */
+/** @brief Speed of sound (cm/us) at ~20°C, no humidity compensation (see setAirConditions()). */
 #define HCSR04_CM_PER_US              (0.0343F)
 
 /** @brief Overall timeout for a single transaction (microseconds, ~5 m round-trip). */
@@ -33,6 +34,21 @@
 /** @brief Minimum allowed idle time between shots (microseconds, datasheet ~60 ms). */
 #define HCSR04_DEFAULT_MIN_CYCLE_US   (60000UL)
 
+/** @brief Datasheet maximum range (centimeters). */
+#define HCSR04_MAX_RANGE_CM           (400U)
+
+/** @brief Allowance from TRIG to ECHO rising edge (8 x 40 kHz burst + module latency, us). */
+#define HCSR04_ECHO_START_LATENCY_US  (1000UL)
+
+/** @brief Residual-echo guard added to a range-derived timeout (us, ~4 m round-trip). */
+#define HCSR04_RANGE_GUARD_US         (25000UL)
+
+/** @brief Shortest ringdown guard accepted by setAdaptiveCycle() (transducer ringdown, us). */
+#define HCSR04_MIN_RINGDOWN_GUARD_US  (2000UL)
+
+/** @brief Compiler barrier: orders plain memory accesses around ISR-shared indices/counters. */
+#define HCSR04_COMPILER_BARRIER()     __asm__ __volatile__("" ::: "memory")
+
 /* ============================== Status codes =============================== */
 
 /**
@@ -47,7 +63,10 @@ typedef enum
   HCSR04_ERR_BUSY               = -4, /**< Operation not allowed while another is pending. */
   HCSR04_ERR_NOT_READY          = -5, /**< Non-blocking read: result not yet ready (not used in polling). */
   HCSR04_ERR_BAD_STATE          = -6, /**< API misuse or invalid configuration. */
-  HCSR04_ERR_BAD_PARAM          = -7  /**< Invalid parameter passed to setter. */
+  HCSR04_ERR_BAD_PARAM          = -7, /**< Invalid parameter passed to setter. */
+  HCSR04_ERR_OUT_OF_RANGE       = -8, /**< Echo window closed early: target beyond max range. */
+  HCSR04_ERR_IMPLAUSIBLE        = -9, /**< Echo rejected by a plausibility gate (e.g. jump). */
+  HCSR04_ERR_CROSSTALK          = -10 /**< Echo not consistent with the sensor's own (dithered) schedule. */
 } HCSR04_Status;
 
 /* ============================= Abstract interface ========================== */
@@ -88,7 +107,14 @@ public:
       m_timeout_us(timeout_us),
       m_cm_per_us(cm_per_us),
       m_min_cycle_us(min_cycle_us),
-      m_last_shot_us(0UL)
+      m_min_cycle_explicit(false),
+      m_last_shot_us(0UL),
+      m_max_range_cm(0U),
+      m_mm_per_us_q16(mmPerUsQ16_(cm_per_us)),
+      m_mm_echo_limit_us(mmEchoLimitUs_(mmPerUsQ16_(cm_per_us))),
+      m_ringdown_guard_us(0UL),
+      m_echo_end_us(0UL),
+      m_echo_end_valid(false)
   {
     /* No dynamic work here. Derived::begin() will configure pin modes. */
   }
@@ -142,6 +168,8 @@ public:
    * @brief Set the round-trip timeout (in microseconds).
    * @param timeout_us Microseconds before giving up (e.g., 30000UL ~5 m RT).
    * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if too small).
+   *
+   * @note An explicit timeout disables a range-derived window set by setMaxRangeCm().
    */
   HCSR04_Status setTimeoutUs(unsigned long timeout_us)
   {
@@ -149,6 +177,31 @@ public:
     if (timeout_us >= (HCSR04_TRIG_PULSE_US + 100UL)) /* simple sanity margin */
     {
       m_timeout_us = timeout_us;
+      m_max_range_cm = 0U;
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  /**
+   * @brief Limit the echo window to targets closer than range_cm.
+   * @param range_cm Maximum distance of interest (1..HCSR04_MAX_RANGE_CM), 0 to disable.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if above HCSR04_MAX_RANGE_CM).
+   *
+   * Derives, from the current sound speed:
+   * - timeout = HCSR04_ECHO_START_LATENCY_US + 2 * range / c;
+   * - min cycle = timeout + HCSR04_RANGE_GUARD_US, capped at HCSR04_DEFAULT_MIN_CYCLE_US.
+   * Missing falling edges then end with HCSR04_ERR_OUT_OF_RANGE. Both values are refreshed
+   * by setSoundSpeed()/setAirConditions(), except a min cycle set with setMinCycleUs()
+   * (before or after), which is always kept. Disabling keeps the current timeout/min cycle.
+   */
+  HCSR04_Status setMaxRangeCm(uint16_t range_cm)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if (range_cm <= HCSR04_MAX_RANGE_CM)
+    {
+      m_max_range_cm = range_cm;
+      applyMaxRange_();
       status = HCSR04_OK;
     }
     return status;
@@ -158,6 +211,9 @@ public:
    * @brief Set the minimum cycle time between shots (in microseconds).
    * @param min_cycle_us Typical >= 60000 us per datasheet guidance.
    * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if zero).
+   *
+   * @note Overrides the cycle derived by setMaxRangeCm() for good: later sound speed
+   *       updates (e.g. periodic temperature compensation) leave it untouched.
    */
   HCSR04_Status setMinCycleUs(unsigned long min_cycle_us)
   {
@@ -165,11 +221,46 @@ public:
     if (min_cycle_us != 0UL)
     {
       m_min_cycle_us = min_cycle_us;
+      m_min_cycle_explicit = true;
       status = HCSR04_OK;
     }
     return status;
   }
 
+  /**
+   * @brief Echo-aware cycle: allow the next shot a guard time after the echo ended.
+   * @param enable true to enable, false to always wait the full min cycle.
+   * @param guard_us Ringdown guard after the ECHO falling edge (>= HCSR04_MIN_RINGDOWN_GUARD_US).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if the guard is too short).
+   *
+   * Next shot allowed at min(shot start + min cycle, echo end + guard_us). Shots
+   * that timed out (no complete echo) always wait the full min cycle. The guard must
+   * cover the farthest reflector in the scene: late echoes of a far wall arriving
+   * after the next TRIG would be read as short "ghost" distances.
+   * Default guard HCSR04_RANGE_GUARD_US (~4 m round trip): ~2x the sample rate at 50 cm
+   * (~4.5x with a 10 ms guard in a room whose walls are within ~1.7 m; see
+   * tools/host/sim_adaptive.cpp).
+   */
+  HCSR04_Status setAdaptiveCycle(bool enable, unsigned long guard_us = HCSR04_RANGE_GUARD_US)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if (enable == false)
+    {
+      m_ringdown_guard_us = 0UL;
+      status = HCSR04_OK;
+    }
+    else if (guard_us >= HCSR04_MIN_RINGDOWN_GUARD_US)
+    {
+      m_ringdown_guard_us = guard_us;
+      status = HCSR04_OK;
+    }
+    else
+    {
+      /* Guard shorter than the transducer ringdown. */
+    }
+    return status;
+  }
+
   /**
    * @brief Set the speed of sound in cm/us (e.g., temperature compensation).
    * @param cm_per_us Centimeters per microsecond (default ~0.0343F @20°C).
@@ -182,6 +273,33 @@ public:
     if ((cm_per_us > 0.02F) && (cm_per_us < 0.06F))
     {
       m_cm_per_us = cm_per_us;
+      setMmScale_(mmPerUsQ16_(cm_per_us));
+      applyMaxRange_();
+      status = HCSR04_OK;
+    }
+
+    return status;
+  }
+
+  /**
+   * @brief Set the speed of sound from air temperature and relative humidity.
+   * @param temp_c_x10 Air temperature in tenths of degree Celsius (-200..500).
+   * @param rh_percent Relative humidity in percent (0..100).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if outside the HCSR04_Air table).
+   *
+   * @note Interpolates the compile-time PROGMEM table of hcsr04_air.hpp (integer only)
+   *       into the Q16 scale used by readMm(); the float scale used by read() is
+   *       refreshed with a single conversion. Range-derived timeouts are updated too.
+   */
+  HCSR04_Status setAirConditions(int16_t temp_c_x10, uint8_t rh_percent)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    const uint16_t mm_per_us_q16 = HCSR04_Air::lookupQ16(temp_c_x10, rh_percent);
+    if (mm_per_us_q16 != 0U)
+    {
+      setMmScale_(mm_per_us_q16);
+      m_cm_per_us = static_cast<float>(mm_per_us_q16) * (1.0F / (5.0F * 65536.0F));
+      applyMaxRange_();
       status = HCSR04_OK;
     }
 
@@ -202,11 +320,29 @@ public:
   /** @brief Get current min cycle (us). */
   unsigned long getMinCycleUs(void) const noexcept { return m_min_cycle_us; }
 
+  /** @brief Get max range of interest (cm, 0 = disabled). */
+  uint16_t getMaxRangeCm(void) const noexcept { return m_max_range_cm; }
+
+  /** @brief Get ringdown guard of the adaptive cycle (us, 0 = disabled). */
+  unsigned long getRingdownGuardUs(void) const noexcept { return m_ringdown_guard_us; }
+
   /** @brief Get current speed of sound (cm/us). */
   float getSoundSpeed(void) const noexcept { return m_cm_per_us; }
 
-  /** @brief Returns micros() timestamp of last shot start mark. */
-  unsigned long getLastShotTimestampUs(void) const noexcept { return m_last_shot_us; }
+  /**
+   * @brief Returns micros() timestamp of last shot start mark.
+   * @note Safe from loop() while an ISR marks shots (read with interrupts masked).
+   *       Virtual so that decorators, which never fire themselves, report the shots
+   *       of the driver they wrap.
+   */
+  virtual unsigned long getLastShotTimestampUs(void) const noexcept
+  {
+    const uint8_t sreg = SREG;
+    cli();
+    const unsigned long shot_us = m_last_shot_us;
+    SREG = sreg;
+    return shot_us;
+  }
 
   /* ---------------------------- Measurement API --------------------------- */
 
@@ -223,6 +359,54 @@ public:
    */
   virtual HCSR04_Status read(float &out_cm) = 0;
 
+  /**
+   * @brief Same shot as read(), reporting the raw ECHO high time (integer API).
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us) = 0;
+
+  /**
+   * @brief Hand over the result of the shot in flight without starting a new one.
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as readRawUs(); HCSR04_ERR_NOT_READY while
+   *         nothing is finished).
+   *
+   * @note For callers that decide themselves when the next shot starts (HCSR04_Array,
+   *       HCSR04_Dither). The default is readRawUs(), which is right for drivers that
+   *       hand a finished shot over before they may start another (pin change, input
+   *       capture; polling is never in flight). HCSR04_Interrupt, whose read triggers
+   *       and pops a buffered record in the same call, overrides it.
+   */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us)
+  {
+    return readRawUs(out_echo_us);
+  }
+
+  /**
+   * @brief Same shot as read(), reporting millimeters with integer arithmetic only.
+   * @param[out] out_mm Distance in millimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   *
+   * @note Uses the Q16 scale cached by setSoundSpeed(): no soft-float on the sample path.
+   *       Approximate cost per conversion (UNO, avr-gcc -Os):
+   *         float path  (timeUsToCm_): ~350 cycles (ulong->float + 2 x fmul)
+   *         integer path (timeUsToMm_): ~60 cycles (32x16 mul + shift; the overflow
+   *                                     bound is cached, no division per sample)
+   *       Flash saving (~1 KB of soft-float) materializes only when nothing else
+   *       references float code (read() stays in the vtable of the virtual drivers).
+   */
+  HCSR04_Status readMm(uint16_t &out_mm)
+  {
+    unsigned long echo_us = 0UL;
+    HCSR04_Status status = readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      status = timeUsToMm_(echo_us, out_mm);
+    }
+    return status;
+  }
+
   /* -------------------------- Rule-of-5 limitations ----------------------- */
 
   IHCSR04(const IHCSR04&) = delete;
@@ -232,27 +416,113 @@ protected:
   /* --------- Helpers for derived implementations (no exceptions) ---------- */
 
   /**
-   * @brief Check if min cycle time has elapsed since last shot.
+   * @brief Check if min cycle time (or the adaptive ringdown guard) has elapsed since last shot.
    * @return HCSR04_Status (HCSR04_OK if shot can start, HCSR04_ERR_BUSY otherwise).
    */
   HCSR04_Status canStartShot_(void) const
   {
     HCSR04_Status status = HCSR04_ERR_BUSY;
     const unsigned long now_us = micros();
-    const unsigned long elapsed = now_us - m_last_shot_us; /* wraps fine on unsigned long */
+
+    /* Shot marks may come from an ISR: take a consistent copy of the 32-bit stamps. */
+    const uint8_t sreg = SREG;
+    cli();
+    const unsigned long shot_us = m_last_shot_us;
+    const unsigned long echo_end_us = m_echo_end_us;
+    const bool echo_end_valid = m_echo_end_valid;
+    SREG = sreg;
+
+    const unsigned long elapsed = now_us - shot_us; /* wraps fine on unsigned long */
     if (elapsed >= m_min_cycle_us)
     {
       status = HCSR04_OK;
     }
+    else if ((m_ringdown_guard_us != 0UL) && (echo_end_valid == true) &&
+             ((now_us - echo_end_us) >= m_ringdown_guard_us))
+    {
+      status = HCSR04_OK;
+    }
+    else
+    {
+      /* Still inside the cycle. */
+    }
+    return status;
+  }
+
+  /**
+   * @brief Record the ECHO falling edge of the current shot (enables the adaptive cycle).
+   * @param echo_end_us micros() at (or, conservatively, after) the falling edge.
+   * @note Call from loop() context only; cleared by markShotStart_().
+   */
+  void noteEchoEnd_(unsigned long echo_end_us)
+  {
+    const uint8_t sreg = SREG;
+    cli();
+    m_echo_end_us = echo_end_us;
+    m_echo_end_valid = true;
+    SREG = sreg;
+  }
+
+  /**
+   * @brief Status for an echo window that closed without a complete pulse.
+   * @param rise_seen true if the ECHO rising edge was captured.
+   * @return HCSR04_ERR_TIMEOUT_ECHO_START, HCSR04_ERR_TIMEOUT_ECHO_END, or
+   *         HCSR04_ERR_OUT_OF_RANGE when the window was shortened by setMaxRangeCm().
+   */
+  HCSR04_Status echoTimeoutStatus_(bool rise_seen) const
+  {
+    HCSR04_Status status = HCSR04_ERR_TIMEOUT_ECHO_START;
+    if (rise_seen == true)
+    {
+      status = (m_max_range_cm != 0U) ? HCSR04_ERR_OUT_OF_RANGE : HCSR04_ERR_TIMEOUT_ECHO_END;
+    }
     return status;
   }
 
   /**
    * @brief Mark the start time of the current shot (called by derived before TRIG).
+   * @note Callable from ISR context (HCSR04_Interrupt continuous mode): both fields
+   *       change together with interrupts masked.
    */
   void markShotStart_(void)
   {
-    m_last_shot_us = micros();
+    const unsigned long now_us = micros();
+    const uint8_t sreg = SREG;
+    cli();
+    m_last_shot_us = now_us;
+    m_echo_end_valid = false;
+    SREG = sreg;
+  }
+
+  /**
+   * @brief TRIG pulse LOW (>= 2 us) -> HIGH (HCSR04_TRIG_PULSE_US) -> LOW on a cached port.
+   * @param trig_out PORTx of the TRIG line(s).
+   * @param trig_mask TRIG bit(s); several bits fire several modules with one pulse.
+   * @note Read-modify-write on PORTx is not atomic: each write masks interrupts like
+   *       digitalWrite() does. Also callable from ISR context.
+   */
+  static void trigPulse_(volatile uint8_t *trig_out, uint8_t trig_mask)
+  {
+    const uint8_t sreg = SREG;
+    cli();
+    *trig_out &= static_cast<uint8_t>(~trig_mask);
+    SREG = sreg;
+    delayMicroseconds(2U);
+    cli();
+    *trig_out |= trig_mask;
+    SREG = sreg;
+    delayMicroseconds(HCSR04_TRIG_PULSE_US);
+    cli();
+    *trig_out &= static_cast<uint8_t>(~trig_mask);
+    SREG = sreg;
+  }
+
+  /**
+   * @brief trigPulse_() on this driver's TRIG pin (resolves the port on every call).
+   */
+  void trigPulse_(void) const
+  {
+    trigPulse_(portOutputRegister(digitalPinToPort(m_trig_pin)), digitalPinToBitMask(m_trig_pin));
   }
 
   /**
@@ -275,14 +545,108 @@ protected:
     return status;
   }
 
+  /**
+   * @brief Convert echo round-trip time (us) to distance (mm) in fixed point.
+   * @param echo_high_us Time ECHO stayed HIGH (round-trip).
+   * @param[out] out_mm Resulting distance in millimeters (rounded).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if echo_high_us==0 or the result
+   *         does not fit 16 bits).
+   *
+   * @note Distance(mm) = (echo_time_us * m_mm_per_us_q16 + 0.5) >> 16
+   */
+  HCSR04_Status timeUsToMm_(unsigned long echo_high_us, uint16_t &out_mm) const
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    /* Product stays below 2^32 for any echo that maps to <= 65535 mm. */
+    if ((echo_high_us != 0UL) && (echo_high_us <= m_mm_echo_limit_us))
+    {
+      out_mm = static_cast<uint16_t>(((echo_high_us * m_mm_per_us_q16) + 0x8000UL) >> 16);
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  /**
+   * @brief Convert echo round-trip time in CPU clock cycles to distance (cm).
+   * @param echo_high_cycles Time ECHO stayed HIGH, in F_CPU cycles (62.5 ns @16 MHz).
+   * @param[out] out_cm Resulting distance in centimeters.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if echo_high_cycles==0).
+   *
+   * @note Keeps sub-microsecond resolution for drivers timing edges in cycles/ticks.
+   */
+  HCSR04_Status timeCyclesToCm_(unsigned long echo_high_cycles, float &out_cm) const
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if (echo_high_cycles != 0UL)
+    {
+      const float half_per_cycle = 0.5F / static_cast<float>(clockCyclesPerMicrosecond());
+      out_cm = (static_cast<float>(echo_high_cycles) * m_cm_per_us) * half_per_cycle;
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
 private:
+  /**
+   * @brief Q16 millimeters per echo microsecond (one way) for a sound speed in cm/us.
+   * @note Config-time only: 0.0343 cm/us -> 11239 (0.1715 mm/us).
+   */
+  static uint16_t mmPerUsQ16_(float cm_per_us)
+  {
+    return static_cast<uint16_t>((cm_per_us * (5.0F * 65536.0F)) + 0.5F);
+  }
+
+  /**
+   * @brief Longest echo (us) timeUsToMm_() accepts for a Q16 scale (0 if the scale is 0).
+   * @note Config-time only: keeps the 32-bit division off the sample path.
+   */
+  static unsigned long mmEchoLimitUs_(uint16_t mm_per_us_q16)
+  {
+    return (mm_per_us_q16 != 0U) ? (0xFFFF0000UL / mm_per_us_q16) : 0UL;
+  }
+
+  /**
+   * @brief Install a new Q16 scale together with its cached echo limit.
+   */
+  void setMmScale_(uint16_t mm_per_us_q16)
+  {
+    m_mm_per_us_q16 = mm_per_us_q16;
+    m_mm_echo_limit_us = mmEchoLimitUs_(mm_per_us_q16);
+  }
+
+  /**
+   * @brief Recompute timeout and min cycle from m_max_range_cm (no-op when disabled).
+   * @note The min cycle is left alone once set explicitly with setMinCycleUs().
+   */
+  void applyMaxRange_(void)
+  {
+    if (m_max_range_cm != 0U)
+    {
+      const float round_trip_us = (2.0F * static_cast<float>(m_max_range_cm)) / m_cm_per_us;
+      m_timeout_us = HCSR04_ECHO_START_LATENCY_US + static_cast<unsigned long>(round_trip_us);
+
+      if (m_min_cycle_explicit == false)
+      {
+        const unsigned long cycle_us = m_timeout_us + HCSR04_RANGE_GUARD_US;
+        m_min_cycle_us = (cycle_us < HCSR04_DEFAULT_MIN_CYCLE_US) ? cycle_us : HCSR04_DEFAULT_MIN_CYCLE_US;
+      }
+    }
+  }
+
   /* ------------------------------ Data members ---------------------------- */
   uint8_t       m_trig_pin;
   uint8_t       m_echo_pin;
   unsigned long m_timeout_us;
   float         m_cm_per_us;
   unsigned long m_min_cycle_us;
-  unsigned long m_last_shot_us;
+  bool          m_min_cycle_explicit;  /**< Set by setMinCycleUs(): not range-derived. */
+  volatile unsigned long m_last_shot_us;    /**< May be written in ISR context. */
+  uint16_t      m_max_range_cm;
+  uint16_t      m_mm_per_us_q16;
+  unsigned long m_mm_echo_limit_us;   /**< 0xFFFF0000 / m_mm_per_us_q16, see timeUsToMm_(). */
+  unsigned long m_ringdown_guard_us;
+  volatile unsigned long m_echo_end_us;
+  volatile bool          m_echo_end_valid;
 };
 
 #endif /* HCSR04_HPP_ */
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file hcsr04_air.hpp
+ * @brief Speed of sound vs air temperature/humidity: compile-time model + PROGMEM lookup.
+ * @version 1.0
+ * @date 2025-10-08
+ *
+ * The physical model is evaluated by the compiler only (C++11 constexpr):
+ * - dry air:   c0 = 331.3 m/s * sqrt(1 + T / 273.15)
+ * - vapour:    p_sat = 611.2 Pa * exp(17.62 T / (243.12 + T))      (Magnus)
+ *              x = RH * p_sat / 101325 Pa                         (mole fraction)
+ * - moist air: c = c0 * (1 + 0.16 x)                              (linearized, x < 0.13)
+ * and stored as a table of Q16 mm per echo microsecond (the IHCSR04 integer scale).
+ * At run time lookupQ16() only interpolates the table linearly in temperature and
+ * humidity: integer multiply/divide, no sqrt, exp or float.
+ *
+ * Table: HCSR04_AIR_T_MIN_C..HCSR04_AIR_T_MAX_C every HCSR04_AIR_T_STEP_C, columns
+ * RH 0 % and 100 % (x is linear in RH). Footprint 15 rows x 4 bytes = 60 bytes of flash.
+ * Interpolation error vs the model <= 2 LSB (~0.06 m/s, worst at 45..50 degC and high RH).
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - C++11 constexpr: single-return recursive functions only.
+ */
+
+#ifndef HCSR04_AIR_HPP_
+#define HCSR04_AIR_HPP_
+
+#include <Arduino.h>
+
+/** @brief Table temperature range and step (degrees Celsius). */
+#define HCSR04_AIR_T_MIN_C            (-20)
+#define HCSR04_AIR_T_MAX_C            (50)
+#define HCSR04_AIR_T_STEP_C           (5)
+
+/** @brief Number of table rows. */
+#define HCSR04_AIR_ROWS               (((HCSR04_AIR_T_MAX_C - HCSR04_AIR_T_MIN_C) / HCSR04_AIR_T_STEP_C) + 1)
+
+/**
+ * @class HCSR04_Air
+ * @brief Static helpers: compile-time sound-speed model and run-time table lookup.
+ */
+class HCSR04_Air
+{
+public:
+  /**
+   * @brief Q16 mm per echo microsecond for the given air conditions.
+   * @param temp_c_x10 Air temperature in tenths of degree Celsius (-200..500).
+   * @param rh_percent Relative humidity in percent (0..100).
+   * @return Q16 scale, or 0 if a parameter is outside the table.
+   *
+   * @note Approximate cost (UNO, avr-gcc -Os): 4 PROGMEM reads + 2 x 16-bit div ~= 500 cycles.
+   */
+  static uint16_t lookupQ16(int16_t temp_c_x10, uint8_t rh_percent);
+
+  /**
+   * @brief Model: Q16 mm per echo microsecond at temp_c, mole fraction from rh (0..1).
+   * @note Compile-time use only (table generation).
+   */
+  static constexpr uint16_t modelQ16(double temp_c, double rh)
+  {
+    return static_cast<uint16_t>((speedMs(temp_c, rh) * (65536.0 / 2000.0)) + 0.5);
+  }
+
+  /** @brief Model: speed of sound in m/s (compile-time use only). */
+  static constexpr double speedMs(double temp_c, double rh)
+  {
+    return (331.3 * sqrt_(1.0 + (temp_c / 273.15), 1.0, 8U)) *
+           (1.0 + (0.16 * ((rh * saturationPa_(temp_c)) / 101325.0)));
+  }
+
+private:
+  /* Newton iterations for sqrt(x) from guess g (x near 1: 8 steps are exact in double). */
+  static constexpr double sqrt_(double x, double g, uint8_t n)
+  {
+    return (n == 0U) ? g : sqrt_(x, 0.5 * (g + (x / g)), static_cast<uint8_t>(n - 1U));
+  }
+
+  /* Taylor series of exp(y): term = y^k / k!, 30 terms cover |y| <= 3.5. */
+  static constexpr double exp_(double y, double term, uint8_t k)
+  {
+    return (k > 30U) ? term : (term + exp_(y, (term * y) / static_cast<double>(k), static_cast<uint8_t>(k + 1U)));
+  }
+
+  /* Magnus saturation vapour pressure over water (Pa). */
+  static constexpr double saturationPa_(double temp_c)
+  {
+    return 611.2 * exp_((17.62 * temp_c) / (243.12 + temp_c), 1.0, 1U);
+  }
+};
+
+#endif /* HCSR04_AIR_HPP_ */
@@ -5,7 +5,32 @@
  * @date 2025-09-09
  *
  * This concrete class derives from IHCSR04 and provides a blocking, polling-based
- * implementation using Arduino's digital I/O and busy-wait loops on ECHO.
+ * implementation using busy-wait loops on ECHO.
+ *
+ * Fast path:
+ * - begin() resolves TRIG/ECHO into cached PORTx/PINx register pointers and bit masks,
+ *   so read() never goes through digitalRead()/digitalWrite() (pin-table lookups).
+ * - Approximate cost per ECHO sample (UNO @16 MHz, avr-gcc -Os, AVR core 1.8.x):
+ *     digitalRead(pin) == HIGH       ~ 55..70 cycles (3 PROGMEM lookups + PWM check)
+ *     (*m_echo_in & m_echo_mask)     ~  4..6  cycles (ld + and + branch)
+ *   Busy-wait iteration incl. micros() and timeout compare drops from ~135 to ~80 cycles
+ *   (~8.4 us -> ~5 us edge timestamp uncertainty); the remainder is micros() itself.
+ * - HCSR04_POLL_LOOP_COUNT drops micros() from the loops entirely: timeout becomes an
+ *   iteration budget and the echo width is (iterations * HCSR04_LOOP_CYCLES_PER_ITER)
+ *   cycles, i.e. ~0.75 us resolution and ~12 cycles per sample.
+ *
+ * Split-phase (cooperative) API: trigger() fires the TRIG pulse and returns at once,
+ * poll() takes at most a bounded number of ECHO samples per call (~80 cycles each),
+ * result() hands over the completed measurement. Edge timestamps are quantized to the
+ * interval between poll() calls (P us => ~P/58 cm). CPU left free over a 60 ms cycle,
+ * assuming poll() every P = 100 us at ~20 us per call (in-flight time T = ~0.5 ms
+ * latency + 58.3 us/cm):
+ *
+ *   distance      T        read() (blocking)   trigger()/poll()   longest stall
+ *   10 cm        1.1 ms        98.2 %              99.6 %         1.1 ms -> 20 us
+ *   100 cm       6.3 ms        89.5 %              97.9 %         6.3 ms -> 20 us
+ *   300 cm      18.0 ms        70.0 %              94.0 %        18.0 ms -> 20 us
+ *   no echo     30.0 ms        50.0 %              90.0 %        30.0 ms -> 20 us
  *
  * Design constraints:
  * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
@@ -18,6 +43,33 @@
 
 #include "hcsr04.hpp"
 
+/**
+ * @brief CPU cycles per iteration of the HCSR04_POLL_LOOP_COUNT busy-wait loop.
+ *
+ * Compile-time calibration constant (override with -DHCSR04_LOOP_CYCLES_PER_ITER=n).
+ * Default tally for avr-gcc -Os: ld (2) + and (1) + branch (1) + 32-bit decrement (4)
+ * + zero test/branch (4) = 12 cycles (0.75 us @16 MHz). The Timer0 tick ISR steals
+ * ~0.5% of the loop time; calibrate against HCSR04_POLL_MICROS on a fixed target if
+ * the toolchain or core differs.
+ */
+#ifndef HCSR04_LOOP_CYCLES_PER_ITER
+#define HCSR04_LOOP_CYCLES_PER_ITER   (12UL)
+#endif
+
+/**
+ * @brief Echo timing strategy used by HCSR04_Polling::read().
+ */
+typedef enum
+{
+  HCSR04_POLL_MICROS     = 0, /**< Timestamp edges with micros() (4 us granularity). */
+  HCSR04_POLL_LOOP_COUNT = 1  /**< Count fixed-cost loop iterations (pulseIn-style). */
+} HCSR04_PollMode;
+
+/** @brief Default maximum number of ECHO samples taken by one poll() call. */
+#ifndef HCSR04_POLL_SAMPLES_PER_CALL
+#define HCSR04_POLL_SAMPLES_PER_CALL  (4U)
+#endif
+
 /**
  * @class HCSR04_Polling
  * @brief Concrete polling driver for HC-SR04 distance measurement.
@@ -38,29 +90,112 @@ public:
                           unsigned long timeout_us = HCSR04_DEFAULT_TIMEOUT_US,
                           float cm_per_us = HCSR04_CM_PER_US,
                           unsigned long min_cycle_us = HCSR04_DEFAULT_MIN_CYCLE_US) :
-    IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us)
+    IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us),
+    m_trig_out(0),
+    m_echo_in(0),
+    m_trig_mask(0U),
+    m_echo_mask(0U),
+    m_poll_mode(HCSR04_POLL_MICROS),
+    m_phase(PHASE_IDLE),
+    m_result(HCSR04_ERR_BAD_STATE),
+    m_t_start_us(0UL),
+    m_t_rise_us(0UL),
+    m_echo_high_us(0UL)
   {
     /* No work. Configuration is finalized in begin(). */
   }
 
   /**
-   * @brief Configure I/O directions and internal state. Call in setup().
-   * @return HCSR04_Status
+   * @brief Configure I/O directions and resolve the port fast path. Call in setup().
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if a pin has no digital port).
    */
   virtual HCSR04_Status begin(void);
 
   /**
    * @brief Perform a single-shot distance measurement (blocking).
    * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
-   * @return HCSR04_Status
+   * @return HCSR04_Status (HCSR04_ERR_BAD_STATE if begin() has not succeeded,
+   *         HCSR04_ERR_BUSY while ECHO is still high from a previous shot or a
+   *         split-phase shot is in flight).
    */
   virtual HCSR04_Status read(float &out_cm);
 
+  /**
+   * @brief Blocking single shot reporting the raw ECHO high time (see IHCSR04::readMm()).
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /* ------------------------ Split-phase (non-blocking) -------------------- */
+
+  /**
+   * @brief Fire the TRIG pulse and return immediately (split-phase start).
+   * @return HCSR04_Status (HCSR04_OK when the shot started, HCSR04_ERR_BUSY if the
+   *         min cycle has not elapsed or a shot is in flight, HCSR04_ERR_BAD_STATE
+   *         if begin() has not succeeded). Any unread result is discarded.
+   */
+  HCSR04_Status trigger(void);
+
+  /**
+   * @brief Advance the in-flight shot with a bounded amount of ECHO sampling.
+   * @param max_samples Upper bound on ECHO samples taken in this call.
+   * @return HCSR04_ERR_NOT_READY while in flight, the final status once complete,
+   *         HCSR04_ERR_BAD_STATE if no shot was triggered.
+   */
+  HCSR04_Status poll(uint8_t max_samples = HCSR04_POLL_SAMPLES_PER_CALL);
+
+  /**
+   * @brief Fetch (and consume) the outcome of the last split-phase shot.
+   * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status (HCSR04_ERR_NOT_READY while in flight,
+   *         HCSR04_ERR_BAD_STATE if there is nothing to report).
+   */
+  HCSR04_Status result(float &out_cm);
+
+  /**
+   * @brief Select how read() times the ECHO pulse.
+   * @param mode HCSR04_POLL_MICROS (default) or HCSR04_POLL_LOOP_COUNT.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if mode is unknown).
+   */
+  HCSR04_Status setPollMode(HCSR04_PollMode mode);
+
+  /** @brief Get current echo timing strategy. */
+  HCSR04_PollMode getPollMode(void) const noexcept { return m_poll_mode; }
+
   /* Rule-of-5: copy disabled in base. No extra resources here. */
   virtual ~HCSR04_Polling() {}
 
 private:
-  /* No data members. Implementation uses base getters and protected helpers. */
+  /** @brief Split-phase state machine. */
+  typedef enum
+  {
+    PHASE_IDLE = 0,
+    PHASE_WAIT_RISE,
+    PHASE_WAIT_FALL,
+    PHASE_DONE
+  } Phase;
+
+  /* Precondition checks + TRIG pulse shared by read() and trigger(). */
+  HCSR04_Status fireTrig_(void);
+
+  /* Echo capture strategies (called right after the TRIG pulse). */
+  HCSR04_Status measureMicros_(unsigned long &echo_high_us) const;
+  HCSR04_Status measureLoopCount_(unsigned long &echo_high_cycles) const;
+
+  /* Cached I/O registers resolved in begin() (call begin() again after changing pins). */
+  volatile uint8_t *m_trig_out;  /**< PORTx register driving TRIG (0 until begin()). */
+  volatile uint8_t *m_echo_in;   /**< PINx register sampling ECHO (0 until begin()). */
+  uint8_t           m_trig_mask; /**< TRIG bit mask within m_trig_out. */
+  uint8_t           m_echo_mask; /**< ECHO bit mask within m_echo_in. */
+  HCSR04_PollMode   m_poll_mode; /**< Echo timing strategy. */
+
+  /* Split-phase shot state. */
+  Phase             m_phase;        /**< Current split-phase state. */
+  HCSR04_Status     m_result;       /**< Final status once m_phase == PHASE_DONE. */
+  unsigned long     m_t_start_us;   /**< micros() right after the TRIG pulse. */
+  unsigned long     m_t_rise_us;    /**< micros() at the observed rising edge. */
+  unsigned long     m_echo_high_us; /**< Echo width once completed with HCSR04_OK. */
 };
 
 #endif /* HCSR04_POLLING_HPP_ */
\ No newline at end of file
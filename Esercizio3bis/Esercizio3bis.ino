@@ -6,14 +6,22 @@
  *
  * Wiring consigliato:
  *   - TRIG -> D9  (OUTPUT)
- *   - ECHO -> D2  (INT0, external interrupt)
+ *   - ECHO -> D2  (INT0, external interrupt) oppure D8 (ICP1, input capture);
+ *              con il driver pin-change qualsiasi pin digitale/analogico
  *
  * Serial: 115200 baud
  */
 
-#define HCSR04_USE_INTERRUPT   1  /* 1=interrupt, 0=polling */
+/* Driver choice: HCSR04_DRIVER_SEL in hcsr04_config.hpp (also read by the driver .cpp files). */
+#include "hcsr04_config.hpp"
 
-#if (HCSR04_USE_INTERRUPT == 1)
+#if (HCSR04_DRIVER_SEL == 3)
+  #include "hcsr04_pcint.hpp"
+  using HCSR04_Driver = HCSR04_PCInt;
+#elif (HCSR04_DRIVER_SEL == 2)
+  #include "hcsr04_input_capture.hpp"
+  using HCSR04_Driver = HCSR04_InputCapture;
+#elif (HCSR04_DRIVER_SEL == 1)
   #include "hcsr04_interrupt.hpp"
   using HCSR04_Driver = HCSR04_Interrupt;
 #else
@@ -25,7 +33,11 @@
 /* ========================= Configurazione ================================= */
 
 static const uint8_t  PIN_TRIG = 9U;   /* D9  */
+#if (HCSR04_DRIVER_SEL == 2)
+static const uint8_t  PIN_ECHO = 8U;   /* D8 = ICP1 */
+#else
 static const uint8_t  PIN_ECHO = 2U;   /* D2 = INT0 */
+#endif
 static const unsigned long TIMEOUT_US   = HCSR04_DEFAULT_TIMEOUT_US;     /* ~30 ms */
 static const unsigned long MIN_CYCLE_US = HCSR04_DEFAULT_MIN_CYCLE_US;   /* ~60 ms */
 static const float SOUND_CM_PER_US      = HCSR04_CM_PER_US;
@@ -61,6 +73,15 @@ static void printStatus_(HCSR04_Status st)
     case HCSR04_ERR_BAD_STATE:
       Serial.print(F("BAD_STATE"));
       break;
+    case HCSR04_ERR_OUT_OF_RANGE:
+      Serial.print(F("OUT_OF_RANGE"));
+      break;
+    case HCSR04_ERR_IMPLAUSIBLE:
+      Serial.print(F("IMPLAUSIBLE"));
+      break;
+    case HCSR04_ERR_CROSSTALK:
+      Serial.print(F("CROSSTALK"));
+      break;
     case HCSR04_ERR_TIMEOUT_TRIG:
     default:
       Serial.print(F("ERR"));
@@ -76,7 +97,13 @@ void setup(void)
   while (!Serial) { /* wait for USB CDC on some boards */ }
 
   Serial.println(F("\n=== HC-SR04 Interrupt Demo ==="));
+#if (HCSR04_DRIVER_SEL == 2)
+  Serial.println(F("Pins: TRIG=D9, ECHO=D8(ICP1)"));
+#elif (HCSR04_DRIVER_SEL == 3)
+  Serial.println(F("Pins: TRIG=D9, ECHO=D2(PCINT18)"));
+#else
   Serial.println(F("Pins: TRIG=D9, ECHO=D2(INT0)"));
+#endif
   Serial.flush();
 
   const HCSR04_Status st = g_sonar.begin();
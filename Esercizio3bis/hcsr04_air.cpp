@@ -0,0 +1,71 @@
+/**
+ * @file hcsr04_air.cpp
+ * @brief PROGMEM sound-speed table (generated at compile time) and its interpolation.
+ * @version 1.0
+ * @date 2025-10-08
+ */
+
+#include "hcsr04_air.hpp"
+
+/* ======== Compile-time table ============================================== */
+
+/* One row per temperature: { RH 0 %, RH 100 % } in Q16 mm/us. */
+#define HCSR04_AIR_ROW(t_c)  { HCSR04_Air::modelQ16((t_c), 0.0), HCSR04_Air::modelQ16((t_c), 1.0) }
+
+static const uint16_t s_air_table[][2] PROGMEM =
+{
+  HCSR04_AIR_ROW(-20.0), HCSR04_AIR_ROW(-15.0), HCSR04_AIR_ROW(-10.0), HCSR04_AIR_ROW(-5.0),
+  HCSR04_AIR_ROW(0.0),   HCSR04_AIR_ROW(5.0),   HCSR04_AIR_ROW(10.0),  HCSR04_AIR_ROW(15.0),
+  HCSR04_AIR_ROW(20.0),  HCSR04_AIR_ROW(25.0),  HCSR04_AIR_ROW(30.0),  HCSR04_AIR_ROW(35.0),
+  HCSR04_AIR_ROW(40.0),  HCSR04_AIR_ROW(45.0),  HCSR04_AIR_ROW(50.0)
+};
+
+static_assert((sizeof(s_air_table) / sizeof(s_air_table[0])) == HCSR04_AIR_ROWS,
+              "hcsr04_air: table rows do not match HCSR04_AIR_T_MIN_C/MAX_C/STEP_C");
+
+/* Reference point: 20 degC dry air must match HCSR04_CM_PER_US (343 m/s, Q16 11239) within 0.1 %. */
+static_assert((HCSR04_Air::modelQ16(20.0, 0.0) > 11228U) && (HCSR04_Air::modelQ16(20.0, 0.0) < 11250U),
+              "hcsr04_air: model drifted from the 20 degC reference");
+
+/* ======== Local helpers =================================================== */
+
+/* Linear interpolation between two increasing Q16 values, frac/den in 0..1 (rounded). */
+static uint16_t lerpQ16_(uint16_t lo, uint16_t hi, uint16_t frac, uint16_t den)
+{
+  const uint16_t delta = static_cast<uint16_t>(hi - lo);
+  return static_cast<uint16_t>(lo + static_cast<uint16_t>(((static_cast<uint32_t>(delta) * frac) + (den / 2U)) / den));
+}
+
+/* ============================== lookupQ16() ============================== */
+
+uint16_t HCSR04_Air::lookupQ16(int16_t temp_c_x10, uint8_t rh_percent)
+{
+  const int16_t t_min_x10 = static_cast<int16_t>(HCSR04_AIR_T_MIN_C * 10);
+  const int16_t t_max_x10 = static_cast<int16_t>(HCSR04_AIR_T_MAX_C * 10);
+  const uint16_t step_x10 = static_cast<uint16_t>(HCSR04_AIR_T_STEP_C * 10);
+  uint16_t q16 = 0U;
+
+  if ((temp_c_x10 >= t_min_x10) && (temp_c_x10 <= t_max_x10) && (rh_percent <= 100U))
+  {
+    const uint16_t offset = static_cast<uint16_t>(temp_c_x10 - t_min_x10);
+    uint8_t row = static_cast<uint8_t>(offset / step_x10);
+    uint16_t frac = static_cast<uint16_t>(offset % step_x10);
+
+    if (row >= (HCSR04_AIR_ROWS - 1))
+    {
+      /* T_MAX exactly: interpolate the last interval at its end. */
+      row = static_cast<uint8_t>(HCSR04_AIR_ROWS - 2);
+      frac = step_x10;
+    }
+
+    const uint16_t dry = lerpQ16_(pgm_read_word(&s_air_table[row][0]),
+                                  pgm_read_word(&s_air_table[row + 1U][0]), frac, step_x10);
+    const uint16_t wet = lerpQ16_(pgm_read_word(&s_air_table[row][1]),
+                                  pgm_read_word(&s_air_table[row + 1U][1]), frac, step_x10);
+
+    /* Humidity always raises c: wet >= dry. */
+    q16 = lerpQ16_(dry, wet, rh_percent, 100U);
+  }
+
+  return q16;
+}
@@ -0,0 +1,532 @@
+/**
+ * @file hcsr04_array.hpp
+ * @brief Multi-sensor scheduler: concurrent firing of non-interfering HC-SR04 drivers.
+ * @version 1.1
+ * @date 2025-10-23
+ *
+ * HCSR04_Array<N> owns N IHCSR04 pointers and a conflict matrix (one bitmask per
+ * sensor). service(), called from loop():
+ * - collects results of sensors in flight through collectRawUs(), which never starts a
+ *   shot (HCSR04_Interrupt would otherwise re-trigger while popping its record);
+ * - fires every idle sensor none of whose conflicting sensors is in flight or finished
+ *   less than the guard time ago, in the order given below.
+ * Conflicts come from geometry (buildConflicts(): headings closer than a minimum
+ * separation can hear each other's bursts) and/or setConflict().
+ *
+ * Non-blocking drivers (interrupt, input capture, pin change) then overlap their echo
+ * windows; a blocking driver (polling) completes inside service() and only benefits
+ * from the shorter serialization (echo + guard instead of a full min cycle).
+ * A shot is detected through getLastShotTimestampUs(), so each driver's own min cycle
+ * is still enforced by its canStartShot_(); the same timestamp orders ties and fills
+ * HCSR04_ArrayResult::shot_us. Decorators (HCSR04_Median, HCSR04_Stats, HCSR04_Gate,
+ * HCSR04_Dither) forward it and collectRawUs() from the driver they wrap and can be
+ * scheduled directly. A custom IHCSR04 must mark its shots (markShotStart_()) or
+ * override the accessor, otherwise it is never seen firing. One whose collecting read
+ * still fires (readRawUs() that triggers and pops, without a collectRawUs()) is caught
+ * by its timestamp and stays in flight with the new shot, but that shot bypasses the
+ * candidate order below and can starve its conflicting sensors.
+ *
+ * Simulated layout (tools/host/sim_array.cpp: this class driving non-blocking model
+ * sensors, service() every 50 us; N sensors evenly spaced on a ring, buildConflicts(60),
+ * 10 ms guard, 30 ms timeout, default 60 ms min cycle). "read() loop" is today's
+ * N x 60 ms; "all conflict" is the scheduler with every pair conflicting:
+ *
+ *    N | Echo     | read() loop | All conflict | Scheduled | Latency (shot -> result)
+ *   ---+----------+-------------+--------------+-----------+-------------------------
+ *    6 | 1 m      |   360 ms    |     98 ms    |   60 ms   |  6.3 ms
+ *    8 | 1 m      |   480 ms    |    131 ms    |   60 ms   |  6.3 ms
+ *   12 | 1 m      |   720 ms    |    196 ms    |   60 ms   |  6.3 ms
+ *    6 | none     |   360 ms    |    240 ms    |   60 ms   | 30 ms (timeout)
+ *    8 | none     |   480 ms    |    320 ms    |   80 ms   | 30 ms (timeout)
+ *   12 | none     |   720 ms    |    480 ms    |   80 ms   | 30 ms (timeout)
+ *
+ * With echoes every sensor runs at its own 60 ms min cycle (combine with
+ * setAdaptiveCycle() to go further). Without echoes the ring needs 2 slots of
+ * timeout + guard; the greedy choice is not an optimal graph coloring in general.
+ * Sweep = time until every sensor reported once; per-sensor latency and period are in
+ * HCSR04_ArrayResult.
+ *
+ * Rate control (setTask()): a sensor with a target period is a periodic task whose
+ * job k is released at r + k * period and due one period later. Candidates are ordered
+ * by priority (higher first), then earliest deadline, then least recently fired; a sensor
+ * without a period (default) runs as fast as its driver allows, after every released
+ * periodic task of its priority. A released job is served by one shot start; a job
+ * still unserved at its deadline is dropped and counted as a miss (no catch-up burst).
+ * With equal priorities this is plain EDF. Results are collected with collectRawUs(),
+ * so only this order starts shots; a shot fired by a collecting read anyway (driver
+ * without collectRawUs()) serves the job if it is released and is extra otherwise.
+ *
+ * Simulated rates (same simulator, echoes at 1 m, 10 s; front sensor 30 Hz with
+ * setAdaptiveCycle() and a 25 ms min cycle, side sensors at the default 60 ms min
+ * cycle, i.e. <= 16.7 Hz; conflicts from buildConflicts(60)):
+ *
+ *   Layout (front prio 1, sides prio 0)        Side target   Front      Each side    Side misses
+ *   -------------------------------------------+-------------+----------+------------+------------
+ *   front + 6 sides at 45 deg steps                5 Hz        30.1 Hz     5.0 Hz       0 %
+ *   front + 6 sides, all in one conflict set       5 Hz        30.1 Hz     5.0 Hz       0 %
+ *   front + 6 sides, all in one conflict set      10 Hz        30.0 Hz     5.2 Hz      48 %
+ *   front + 6 sides at 45 deg steps               20 Hz        30.1 Hz    15.1 Hz      25 %
+ *
+ * Under overload the high-priority task keeps its rate and the others share what is
+ * left evenly (least recently fired first), each reporting its misses.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Header-only template, fixed tables, N <= 16 (16-bit masks); scheduling pass O(N^2).
+ */
+
+#ifndef HCSR04_ARRAY_HPP_
+#define HCSR04_ARRAY_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief Default quiet time after a conflicting sensor finished (us). */
+#define HCSR04_ARRAY_GUARD_US         (10000UL)
+
+/** @brief Default minimum heading separation of non-conflicting sensors (degrees). */
+#define HCSR04_ARRAY_MIN_SEP_DEG      (60U)
+
+/**
+ * @brief Latest outcome of one sensor of the array.
+ */
+typedef struct
+{
+  unsigned long  echo_us;     /**< Echo time (HCSR04_OK only). */
+  unsigned long  shot_us;     /**< micros() at shot start. */
+  unsigned long  latency_us;  /**< Shot start -> result collected. */
+  unsigned long  period_us;   /**< Time since the previous result of this sensor. */
+  HCSR04_Status  status;      /**< Driver status of the shot. */
+  uint16_t       seq;         /**< Results collected for this sensor (wraps). */
+} HCSR04_ArrayResult;
+
+/**
+ * @class HCSR04_Array
+ * @brief Crosstalk-aware scheduler over N drivers.
+ * @tparam N Number of sensors, 1..16.
+ */
+template <uint8_t N>
+class HCSR04_Array
+{
+  static_assert((N >= 1U) && (N <= 16U), "HCSR04_Array: 1..16 sensors");
+
+public:
+  /**
+   * @param sensors N driver pointers (must outlive the array; not begun yet).
+   */
+  explicit HCSR04_Array(IHCSR04 * const sensors[N]) :
+    m_active(0U),
+    m_pending(allMask_()),
+    m_guard_us(HCSR04_ARRAY_GUARD_US),
+    m_sweep_start_us(0UL),
+    m_sweep_us(0UL),
+    m_sweeps(0U),
+    m_next(0U)
+  {
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      m_sensors[i] = sensors[i];
+      m_conflict[i] = 0U;
+      m_heading_deg[i] = 0;
+      m_done_us[i] = 0UL;
+      m_period_us[i] = 0UL;
+      m_release_us[i] = 0UL;
+      m_misses[i] = 0U;
+      m_priority[i] = 0U;
+      m_result[i].echo_us = 0UL;
+      m_result[i].shot_us = 0UL;
+      m_result[i].latency_us = 0UL;
+      m_result[i].period_us = 0UL;
+      m_result[i].status = HCSR04_ERR_NOT_READY;
+      m_result[i].seq = 0U;
+    }
+  }
+
+  /**
+   * @brief begin() every sensor. Call in setup().
+   * @return HCSR04_OK, or the first failing sensor's status.
+   */
+  HCSR04_Status begin(void)
+  {
+    HCSR04_Status status = HCSR04_OK;
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      const HCSR04_Status st = m_sensors[i]->begin();
+      if ((st != HCSR04_OK) && (status == HCSR04_OK))
+      {
+        status = st;
+      }
+    }
+    m_sweep_start_us = micros();
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      m_release_us[i] = m_sweep_start_us;
+      m_misses[i] = 0U;
+    }
+    return status;
+  }
+
+  /**
+   * @brief Set a sensor's target period and priority.
+   * @param index Sensor index.
+   * @param period_us Target period (0: as fast as the driver allows, no deadlines).
+   *        Should not be shorter than the driver's min cycle, or jobs are missed.
+   * @param priority Higher is served first among released candidates (default 0).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on bad index).
+   * @note The first job is released at once; misses are counted from then on.
+   */
+  HCSR04_Status setTask(uint8_t index, unsigned long period_us, uint8_t priority)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if (index < N)
+    {
+      m_period_us[index] = period_us;
+      m_priority[index] = priority;
+      m_release_us[index] = micros();
+      m_misses[index] = 0U;
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  /**
+   * @brief Set a sensor's beam heading (used by buildConflicts()).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on bad index).
+   */
+  HCSR04_Status setHeading(uint8_t index, int16_t heading_deg)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if (index < N)
+    {
+      m_heading_deg[index] = heading_deg;
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  /**
+   * @brief Rebuild the conflict matrix: sensors whose headings differ by less than
+   *        min_sep_deg can hear each other (HC-SR04 cone ~30 deg plus reflections).
+   */
+  void buildConflicts(uint16_t min_sep_deg = HCSR04_ARRAY_MIN_SEP_DEG)
+  {
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      m_conflict[i] = 0U;
+    }
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      for (uint8_t j = static_cast<uint8_t>(i + 1U); j < N; j++)
+      {
+        if (separationDeg_(m_heading_deg[i], m_heading_deg[j]) < min_sep_deg)
+        {
+          (void)setConflict(i, j, true);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Declare (or clear) that two sensors must not be in flight together.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on bad or equal indices).
+   */
+  HCSR04_Status setConflict(uint8_t a, uint8_t b, bool conflict)
+  {
+    HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+    if ((a < N) && (b < N) && (a != b))
+    {
+      const uint16_t bit_a = static_cast<uint16_t>(1U << a);
+      const uint16_t bit_b = static_cast<uint16_t>(1U << b);
+      if (conflict == true)
+      {
+        m_conflict[a] |= bit_b;
+        m_conflict[b] |= bit_a;
+      }
+      else
+      {
+        m_conflict[a] &= static_cast<uint16_t>(~bit_b);
+        m_conflict[b] &= static_cast<uint16_t>(~bit_a);
+      }
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  /** @brief Quiet time after a conflicting sensor finished before firing (us). */
+  void setGuardUs(unsigned long guard_us) { m_guard_us = guard_us; }
+
+  /**
+   * @brief Collect finished shots and fire every sensor that may fire. Call from loop().
+   * @return Number of results collected in this call.
+   */
+  uint8_t service(void)
+  {
+    uint8_t collected = 0U;
+
+    /* 1) Collect sensors in flight, without triggering them. */
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      const uint16_t bit = static_cast<uint16_t>(1U << i);
+      if ((m_active & bit) != 0U)
+      {
+        const unsigned long shot_us = m_sensors[i]->getLastShotTimestampUs();
+        unsigned long echo_us = 0UL;
+        const HCSR04_Status st = m_sensors[i]->collectRawUs(echo_us);
+        if (isFinal_(st) == true)
+        {
+          store_(i, st, echo_us, shot_us);
+          collected++;
+        }
+        if (m_sensors[i]->getLastShotTimestampUs() != shot_us)
+        {
+          /* The collecting read fired again (a driver without collectRawUs()): that shot
+             stays in flight and serves the current job if it is released. */
+          if (released_(i, micros()) == true)
+          {
+            m_release_us[i] += m_period_us[i];
+          }
+        }
+        else if (isFinal_(st) == true)
+        {
+          m_active &= static_cast<uint16_t>(~bit);
+        }
+        else
+        {
+          /* Still in flight. */
+        }
+      }
+    }
+
+    /* 2) Drop jobs whose deadline passed unserved. */
+    const unsigned long now_us = micros();
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      while ((m_period_us[i] != 0UL) &&
+             (static_cast<long>(now_us - (m_release_us[i] + m_period_us[i])) >= 0L))
+      {
+        m_release_us[i] += m_period_us[i];
+        if (m_misses[i] < 0xFFFFU)
+        {
+          m_misses[i]++;
+        }
+      }
+    }
+
+    /* 3) Fire: best candidate first, until none is left. */
+    uint16_t tried = m_active;
+    for (uint8_t pass = 0U; pass < N; pass++)
+    {
+      const uint8_t i = pick_(tried, now_us);
+      if (i < N)
+      {
+        const uint16_t bit = static_cast<uint16_t>(1U << i);
+        const unsigned long shot_before = m_sensors[i]->getLastShotTimestampUs();
+        unsigned long echo_us = 0UL;
+        const HCSR04_Status st = m_sensors[i]->readRawUs(echo_us);
+
+        tried |= bit;
+        if (m_sensors[i]->getLastShotTimestampUs() != shot_before)
+        {
+          m_next = static_cast<uint8_t>((i + 1U) % N);
+          m_release_us[i] += m_period_us[i];  /* Job served: next release. */
+          if (isFinal_(st) == true)
+          {
+            /* Blocking driver: the shot already completed. */
+            store_(i, st, echo_us, m_sensors[i]->getLastShotTimestampUs());
+            collected++;
+          }
+          else
+          {
+            m_active |= bit;
+          }
+        }
+      }
+    }
+
+    return collected;
+  }
+
+  /**
+   * @brief Latest outcome of a sensor.
+   * @return false on bad index or before its first result.
+   */
+  bool getResult(uint8_t index, HCSR04_ArrayResult &out) const
+  {
+    bool valid = false;
+    if ((index < N) && (m_result[index].seq != 0U))
+    {
+      out = m_result[index];
+      valid = true;
+    }
+    return valid;
+  }
+
+  /** @brief Duration of the last complete sweep (every sensor reported once, us). */
+  unsigned long getSweepUs(void) const noexcept { return m_sweep_us; }
+
+  /** @brief Jobs of a periodic sensor dropped at their deadline since begin()/setTask() (saturates). */
+  uint16_t getDeadlineMisses(uint8_t index) const { return (index < N) ? m_misses[index] : 0U; }
+
+  /** @brief Completed sweeps (wraps). */
+  uint16_t getSweepCount(void) const noexcept { return m_sweeps; }
+
+  /** @brief Conflict mask of a sensor (bit j set: conflicts with sensor j). */
+  uint16_t getConflictMask(uint8_t index) const { return (index < N) ? m_conflict[index] : 0U; }
+
+private:
+  static uint16_t allMask_(void)
+  {
+    return (N == 16U) ? 0xFFFFU : static_cast<uint16_t>((1UL << N) - 1UL);
+  }
+
+  /* Smallest angle between two headings (0..180). */
+  static uint16_t separationDeg_(int16_t a, int16_t b)
+  {
+    long diff = (static_cast<long>(a) - static_cast<long>(b)) % 360L;
+    if (diff < 0L)
+    {
+      diff += 360L;
+    }
+    return static_cast<uint16_t>((diff > 180L) ? (360L - diff) : diff);
+  }
+
+  /* "No new shot" statuses keep a sensor in flight; anything else closes the shot. */
+  static bool isFinal_(HCSR04_Status st)
+  {
+    return ((st != HCSR04_ERR_NOT_READY) && (st != HCSR04_ERR_BUSY));
+  }
+
+  /* Best untried candidate: released, quiet conflicts; N if none. */
+  uint8_t pick_(uint16_t tried, unsigned long now_us) const
+  {
+    uint8_t best = N;
+    for (uint8_t k = 0U; k < N; k++)
+    {
+      const uint8_t i = static_cast<uint8_t>((m_next + k) % N);
+
+      if (((tried & static_cast<uint16_t>(1U << i)) == 0U) && (released_(i, now_us) == true) &&
+          (mayFire_(i) == true) && ((best == N) || (before_(i, best) == true)))
+      {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  /* Ordering: priority, then periodic before best effort, then earliest deadline, then
+     least recently fired (fair under overload). Full ties keep pick_()'s round-robin. */
+  bool before_(uint8_t a, uint8_t b) const
+  {
+    bool first = false;
+    long due_diff = 0L;
+
+    if ((m_period_us[a] != 0UL) && (m_period_us[b] != 0UL))
+    {
+      due_diff = static_cast<long>((m_release_us[a] + m_period_us[a]) -
+                                   (m_release_us[b] + m_period_us[b]));
+    }
+
+    if (m_priority[a] != m_priority[b])
+    {
+      first = (m_priority[a] > m_priority[b]);
+    }
+    else if ((m_period_us[a] == 0UL) != (m_period_us[b] == 0UL))
+    {
+      first = (m_period_us[a] != 0UL);
+    }
+    else if (due_diff != 0L)
+    {
+      first = (due_diff < 0L);
+    }
+    else
+    {
+      first = (static_cast<long>(m_sensors[a]->getLastShotTimestampUs() -
+                                 m_sensors[b]->getLastShotTimestampUs()) < 0L);
+    }
+    return first;
+  }
+
+  /* Current job released (always, without a period). */
+  bool released_(uint8_t index, unsigned long now_us) const
+  {
+    return ((m_period_us[index] == 0UL) || (static_cast<long>(now_us - m_release_us[index]) >= 0L));
+  }
+
+  /* No conflicting sensor in flight or inside its guard time. Inside its own guard
+     time a sensor also yields to released conflicting sensors that fired less recently:
+     with a min cycle shorter than latency + guard it would otherwise re-fire before
+     they are ever quiet. */
+  bool mayFire_(uint8_t index) const
+  {
+    bool quiet = ((m_conflict[index] & m_active) == 0U);
+    const unsigned long now_us = micros();
+    const bool own_guard = ((m_result[index].seq != 0U) && ((now_us - m_done_us[index]) < m_guard_us));
+    for (uint8_t j = 0U; (j < N) && (quiet == true); j++)
+    {
+      if ((m_conflict[index] & static_cast<uint16_t>(1U << j)) != 0U)
+      {
+        if ((m_result[j].seq != 0U) && ((now_us - m_done_us[j]) < m_guard_us))
+        {
+          quiet = false;
+        }
+        else if ((own_guard == true) && (released_(j, now_us) == true) &&
+                 (static_cast<long>(m_sensors[j]->getLastShotTimestampUs() -
+                                    m_sensors[index]->getLastShotTimestampUs()) < 0L))
+        {
+          quiet = false;
+        }
+        else
+        {
+          /* Quiet towards j. */
+        }
+      }
+    }
+    return quiet;
+  }
+
+  /* shot_us: start of the shot the result belongs to (not necessarily the latest). */
+  void store_(uint8_t index, HCSR04_Status st, unsigned long echo_us, unsigned long shot_us)
+  {
+    const unsigned long now_us = micros();
+    HCSR04_ArrayResult &res = m_result[index];
+
+    res.period_us = now_us - m_done_us[index];
+    res.shot_us = shot_us;
+    res.latency_us = now_us - res.shot_us;
+    res.echo_us = (st == HCSR04_OK) ? echo_us : 0UL;
+    res.status = st;
+    res.seq++;
+    if (res.seq == 0U)
+    {
+      res.seq = 1U;  /* 0 means "no result yet". */
+    }
+    m_done_us[index] = now_us;
+
+    m_pending &= static_cast<uint16_t>(~static_cast<uint16_t>(1U << index));
+    if (m_pending == 0U)
+    {
+      m_sweep_us = now_us - m_sweep_start_us;
+      m_sweep_start_us = now_us;
+      m_sweeps++;
+      m_pending = allMask_();
+    }
+  }
+
+  IHCSR04           *m_sensors[N];
+  uint16_t           m_conflict[N];
+  int16_t            m_heading_deg[N];
+  unsigned long      m_done_us[N];     /**< micros() when each sensor's last result arrived. */
+  HCSR04_ArrayResult m_result[N];
+  unsigned long      m_period_us[N];   /**< Target period (0: best effort). */
+  unsigned long      m_release_us[N];  /**< Release of the current job. */
+  uint16_t           m_misses[N];
+  uint8_t            m_priority[N];
+  uint16_t           m_active;         /**< Sensors in flight. */
+  uint16_t           m_pending;        /**< Sensors not yet reported in the current sweep. */
+  unsigned long      m_guard_us;
+  unsigned long      m_sweep_start_us;
+  unsigned long      m_sweep_us;
+  uint16_t           m_sweeps;
+  uint8_t            m_next;
+};
+
+#endif /* HCSR04_ARRAY_HPP_ */
@@ -0,0 +1,48 @@
+/**
+ * @file hcsr04_config.hpp
+ * @brief Build configuration of the Esercizio3bis sketch: driver choice and owned vectors.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * The Arduino IDE compiles and links every .cpp of the sketch folder, whether the
+ * sketch uses that driver or not, and a #define in the .ino does not reach the other
+ * translation units. The interrupt vectors of the optional drivers are therefore
+ * compiled only when their switch below is 1; by default each follows
+ * HCSR04_DRIVER_SEL, so a build defines only the vectors of the driver it uses and
+ * SoftwareSerial (PCINT0..2), tone() (TIMER2_COMPA), Servo (TIMER1) or analogRead()
+ * users are left alone.
+ *
+ * Edit the values here (or pass -D... in a makefile build). A driver whose vectors
+ * are compiled out refuses begin() with HCSR04_ERR_BAD_STATE: enabling an interrupt
+ * without its vector would reset the MCU.
+ */
+
+#ifndef HCSR04_CONFIG_HPP_
+#define HCSR04_CONFIG_HPP_
+
+/** @brief Driver of Esercizio3bis.ino: 0=polling, 1=interrupt (INT0), 2=input capture (ICP1), 3=pin change. */
+#ifndef HCSR04_DRIVER_SEL
+#define HCSR04_DRIVER_SEL             (1)
+#endif
+
+/** @brief 1: hcsr04_pcint.cpp defines PCINT0_vect..PCINT2_vect (HCSR04_PCInt). */
+#ifndef HCSR04_VECT_PCINT
+#define HCSR04_VECT_PCINT             (HCSR04_DRIVER_SEL == 3)
+#endif
+
+/** @brief 1: hcsr04_interrupt.cpp defines TIMER2_COMPA_vect (HCSR04_Interrupt deadline tick). */
+#ifndef HCSR04_VECT_TIMER2
+#define HCSR04_VECT_TIMER2            (HCSR04_DRIVER_SEL == 1)
+#endif
+
+/** @brief 1: hcsr04_input_capture.cpp defines TIMER1_CAPT_vect and TIMER1_OVF_vect. */
+#ifndef HCSR04_VECT_TIMER1
+#define HCSR04_VECT_TIMER1            (HCSR04_DRIVER_SEL == 2)
+#endif
+
+/** @brief 1: hcsr04_temp_comp.cpp defines ADC_vect (HCSR04_TempCompensator; not used by the demo). */
+#ifndef HCSR04_VECT_ADC
+#define HCSR04_VECT_ADC               (0)
+#endif
+
+#endif /* HCSR04_CONFIG_HPP_ */
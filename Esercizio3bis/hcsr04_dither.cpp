@@ -0,0 +1,209 @@
+/**
+ * @file hcsr04_dither.cpp
+ * @brief Implementation of HCSR04_Dither (jittered trigger schedule + consistency check).
+ * @version 1.0
+ * @date 2025-10-22
+ */
+
+#include "hcsr04_dither.hpp"
+
+/* ======== Local constants ================================================= */
+static const uint32_t HCSR04_DITHER_DEFAULT_SEED = 0x2545F491UL;
+
+/* ============================= Constructor =============================== */
+
+HCSR04_Dither::HCSR04_Dither(IHCSR04 &inner, uint32_t seed) :
+  IHCSR04(inner.getTrigPin(), inner.getEchoPin(), inner.getTimeoutUs(),
+          inner.getSoundSpeed(), inner.getMinCycleUs()),
+  m_inner(inner),
+  m_rng((seed != 0UL) ? seed : HCSR04_DITHER_DEFAULT_SEED),
+  m_fire_after_us(0UL),
+  m_max_jitter_us(HCSR04_DITHER_MAX_US),
+  m_tol_us(HCSR04_DITHER_TOL_US),
+  m_hist_count(0U),
+  m_rejected(0U),
+  m_in_flight(false)
+{
+  m_hist_us[0] = 0UL;
+  m_hist_us[1] = 0UL;
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_Dither::begin(void)
+{
+  m_hist_count = 0U;
+  m_rejected = 0U;
+  m_in_flight = false;
+  m_fire_after_us = micros() + (random_() % (m_max_jitter_us + 1UL));
+  (void)setSoundSpeed(m_inner.getSoundSpeed());
+  return m_inner.begin();
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_Dither::read(float &out_cm)
+{
+  unsigned long echo_us = 0UL;
+  HCSR04_Status status = dither_(echo_us, false);
+
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeUsToCm_(echo_us, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_Dither::readRawUs(unsigned long &out_echo_us)
+{
+  unsigned long echo_us = 0UL;
+  const HCSR04_Status status = dither_(echo_us, false);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = echo_us;
+  }
+
+  return status;
+}
+
+/* ============================ collectRawUs() ============================= */
+
+HCSR04_Status HCSR04_Dither::collectRawUs(unsigned long &out_echo_us)
+{
+  unsigned long echo_us = 0UL;
+  const HCSR04_Status status = dither_(echo_us, true);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = echo_us;
+  }
+
+  return status;
+}
+
+/* ============================== dither_() ================================ */
+
+HCSR04_Status HCSR04_Dither::dither_(unsigned long &echo_us, bool collect_only)
+{
+  HCSR04_Status status = HCSR04_ERR_BUSY;
+  unsigned long raw_us = 0UL;
+
+  if (m_in_flight == true)
+  {
+    /* Collect only: a read of HCSR04_Interrupt would start the next shot at once,
+       without its random delay. */
+    status = m_inner.collectRawUs(raw_us);
+  }
+  else if (collect_only == true)
+  {
+    status = HCSR04_ERR_NOT_READY;
+  }
+  else if (static_cast<long>(micros() - m_fire_after_us) >= 0L)
+  {
+    const unsigned long shot_before = m_inner.getLastShotTimestampUs();
+    status = m_inner.readRawUs(raw_us);
+    if (m_inner.getLastShotTimestampUs() != shot_before)
+    {
+      m_in_flight = true;
+    }
+    else if ((status != HCSR04_ERR_BAD_STATE) && (status != HCSR04_ERR_BAD_PARAM))
+    {
+      /* No shot of ours (wrapped driver still inside its cycle, or a stale result). */
+      status = HCSR04_ERR_BUSY;
+    }
+    else
+    {
+      /* Configuration error: pass through. */
+    }
+  }
+  else
+  {
+    /* Jitter delay still running. */
+  }
+
+  if ((m_in_flight == true) && (status != HCSR04_ERR_NOT_READY) && (status != HCSR04_ERR_BUSY))
+  {
+    m_in_flight = false;
+
+    if (status == HCSR04_OK)
+    {
+      bool consistent = false;
+      for (uint8_t i = 0U; i < m_hist_count; i++)
+      {
+        const unsigned long diff = (raw_us > m_hist_us[i]) ? (raw_us - m_hist_us[i])
+                                                           : (m_hist_us[i] - raw_us);
+        if (diff <= m_tol_us)
+        {
+          consistent = true;
+        }
+      }
+
+      m_hist_us[1] = m_hist_us[0];
+      m_hist_us[0] = raw_us;
+      if (m_hist_count < 2U)
+      {
+        m_hist_count++;
+      }
+
+      if (consistent == true)
+      {
+        echo_us = raw_us;
+      }
+      else
+      {
+        status = HCSR04_ERR_CROSSTALK;
+        if (m_rejected < 0xFFFFU)
+        {
+          m_rejected++;
+        }
+      }
+    }
+
+    arm_(status);
+  }
+
+  return status;
+}
+
+/* ================================ arm_() ================================= */
+
+void HCSR04_Dither::arm_(HCSR04_Status last_status)
+{
+  const unsigned long jitter_us = (m_max_jitter_us != 0UL) ? (random_() % (m_max_jitter_us + 1UL))
+                                                           : 0UL;
+  unsigned long earliest_us = m_inner.getLastShotTimestampUs() + m_inner.getMinCycleUs();
+
+  /* Adaptive cycle: after an echo the wrapped driver may restart one guard after its end. */
+  if ((last_status == HCSR04_OK) && (m_inner.getRingdownGuardUs() != 0UL))
+  {
+    const unsigned long adaptive_us = micros() + m_inner.getRingdownGuardUs();
+    if (static_cast<long>(adaptive_us - earliest_us) < 0L)
+    {
+      earliest_us = adaptive_us;
+    }
+  }
+
+  m_fire_after_us = earliest_us + jitter_us;
+}
+
+/* =============================== random_() =============================== */
+
+uint32_t HCSR04_Dither::random_(void)
+{
+  /* Marsaglia xorshift32 (13, 17, 5): period 2^32 - 1, never returns 0. */
+  uint32_t x = m_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  m_rng = x;
+  return x;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file hcsr04_dither.hpp
+ * @brief Randomized trigger dithering with schedule-consistency check (crosstalk rejection).
+ * @version 1.0
+ * @date 2025-10-22
+ *
+ * Sensors running at the same min cycle keep a constant phase: a neighbour's burst then
+ * lands at the same offset in every listening window and yields a steady, believable
+ * ghost. HCSR04_Dither delays every shot of the wrapped driver by a pseudo-random
+ * 0..max jitter (xorshift32) on top of its cycle. A true echo is timed from this
+ * sensor's own TRIG, so it stays put; a foreign burst is timed from an unrelated
+ * schedule and moves by the random jitter difference from shot to shot.
+ *
+ * Consistency check: an echo is accepted only if it is within the tolerance of one of
+ * the previous two echoes of this sensor; otherwise HCSR04_ERR_CROSSTALK. Comparing with
+ * two shots lets the reading after a rejected ghost through. Cost: the first reading
+ * after begin() and the first after a real jump larger than the tolerance are reported
+ * as HCSR04_ERR_CROSSTALK.
+ *
+ * Simulated layout (tools/host/sim_dither.cpp, this class over crosstalk model sensors:
+ * 4 sensors facing one wall at 1 m, each hearing the other three over a 1.1 m path,
+ * 60 ms min cycle, sensors started 2 ms apart, 4000 shots per sensor, 300 us tolerance;
+ * percentages of all shots):
+ *
+ *   Mode                        Shot period   Ghosts     Ghosts accepted   Valid
+ *                                             measured   (error > 10 cm)   readings
+ *   ---------------------------+-------------+----------+-----------------+---------
+ *   Fixed cycle                  60.0 ms       75 %       75 %              25 %
+ *   Fixed cycle + check          60.0 ms       75 %       75 %              25 %
+ *   Jitter 0..4 ms + check       62.0 ms       23 %       5.1 %             74 %
+ *   Jitter 0..8 ms + check       64.0 ms       23 %       3.0 %             72 %
+ *   Jitter 0..20 ms + check      70.1 ms       22 %       1.5 %             73 %
+ *
+ * A ghost still passes when two consecutive ghosts land within the tolerance of each
+ * other (probability ~ tolerance / jitter): combine with HCSR04_Gate or HCSR04_Median
+ * for the residue, or widen the jitter.
+ *
+ * The jitter range sets the trade-off: wider spreads the sensors further apart (fewer
+ * ghosts at all), narrower stays nearer the min cycle. Timing stays on the wrapped
+ * driver; the decorator only postpones the read() that starts a shot (HCSR04_ERR_BUSY
+ * meanwhile) and collects the shot in flight with collectRawUs(), so HCSR04_Interrupt,
+ * whose read would trigger and pop in one call, never restarts before the delay. Not
+ * for HCSR04_Interrupt in continuous mode (the Timer2 tick fires shots).
+ * Shots are detected, and reported by getLastShotTimestampUs(), through the wrapped
+ * driver's timestamp: it may itself be a decorator (e.g. HCSR04_Median), and
+ * HCSR04_Array or HCSR04_Tracker see the dithered shots.
+ *
+ * Conversion uses this object's own Q16 scale (copied from the wrapped driver in the
+ * constructor and in begin()): apply setSoundSpeed()/setAirConditions() to the
+ * decorator.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ */
+
+#ifndef HCSR04_DITHER_HPP_
+#define HCSR04_DITHER_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief Default maximum trigger jitter added to the cycle (us). */
+#define HCSR04_DITHER_MAX_US          (8000UL)
+
+/** @brief Default shot-to-shot echo tolerance (us, ~5 cm of target motion). */
+#define HCSR04_DITHER_TOL_US          (300UL)
+
+/**
+ * @class HCSR04_Dither
+ * @brief Jittered trigger schedule plus consistency check for any IHCSR04.
+ */
+class HCSR04_Dither : public IHCSR04
+{
+public:
+  /**
+   * @param inner Driver to dither (must outlive the decorator).
+   * @param seed xorshift32 seed; use a different one per sensor (0 is replaced).
+   */
+  HCSR04_Dither(IHCSR04 &inner, uint32_t seed);
+
+  virtual ~HCSR04_Dither() {}
+
+  /**
+   * @brief Start the wrapped driver and clear the echo history.
+   * @return Status of the wrapped driver's begin().
+   */
+  virtual HCSR04_Status begin(void);
+
+  /**
+   * @brief Dithered, consistency-checked read in centimeters.
+   * @return HCSR04_ERR_BUSY while the jitter delay runs, HCSR04_ERR_CROSSTALK for an
+   *         inconsistent echo, otherwise the wrapped driver's status.
+   */
+  virtual HCSR04_Status read(float &out_cm);
+
+  /**
+   * @brief As read(), reporting the raw echo high time.
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief Checked result of the shot in flight, without starting a new one.
+   * @return HCSR04_ERR_NOT_READY when no shot is in flight, otherwise as readRawUs().
+   */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us);
+
+  /** @brief Maximum random delay added to every shot (us, 0 disables dithering). */
+  void setJitterUs(unsigned long max_jitter_us) { m_max_jitter_us = max_jitter_us; }
+
+  /** @brief Largest shot-to-shot echo change accepted as consistent (us). */
+  void setToleranceUs(unsigned long tol_us) { m_tol_us = tol_us; }
+
+  /** @brief Echoes rejected as HCSR04_ERR_CROSSTALK since begin() (saturates). */
+  uint16_t getRejected(void) const noexcept { return m_rejected; }
+
+  /** @brief Shot timestamp of the wrapped driver (the decorator never fires). */
+  virtual unsigned long getLastShotTimestampUs(void) const noexcept
+  {
+    return m_inner.getLastShotTimestampUs();
+  }
+
+private:
+  /* Hold, forward to the wrapped driver and check the echo of each finished shot
+     (collect_only: never start one). */
+  HCSR04_Status dither_(unsigned long &echo_us, bool collect_only);
+
+  /* Schedule the next shot: wrapped driver's earliest start plus a random delay. */
+  void arm_(HCSR04_Status last_status);
+
+  /* xorshift32 step. */
+  uint32_t random_(void);
+
+  IHCSR04       &m_inner;
+  uint32_t       m_rng;
+  unsigned long  m_fire_after_us;   /**< No new shot before this micros() value. */
+  unsigned long  m_max_jitter_us;
+  unsigned long  m_tol_us;
+  unsigned long  m_hist_us[2];      /**< Last two echoes (index 0 newest). */
+  uint8_t        m_hist_count;      /**< Valid entries in m_hist_us. */
+  uint16_t       m_rejected;
+  bool           m_in_flight;       /**< Wrapped driver fired, result not yet collected. */
+};
+
+#endif /* HCSR04_DITHER_HPP_ */
@@ -0,0 +1,216 @@
+/**
+ * @file hcsr04_gate.cpp
+ * @brief Implementation of HCSR04_Gate (plausibility gate + Hold-Last-Value).
+ * @version 1.1
+ * @date 2025-10-17
+ */
+
+#include "hcsr04_gate.hpp"
+
+/* ============================= Constructor =============================== */
+
+HCSR04_Gate::HCSR04_Gate(IHCSR04 &inner) :
+  IHCSR04(inner.getTrigPin(), inner.getEchoPin(), inner.getTimeoutUs(),
+          inner.getSoundSpeed(), inner.getMinCycleUs()),
+  m_inner(inner),
+  m_last_good_us(0UL),
+  m_last_good_mm(0U),
+  m_min_mm(HCSR04_GATE_MIN_MM),
+  m_max_mm(HCSR04_GATE_MAX_MM),
+  m_max_jump_mm(0U),
+  m_max_hold(0U),
+  m_stale(0U),
+  m_cand_mm(0U),
+  m_cand_count(0U),
+  m_reacquire(HCSR04_GATE_REACQUIRE),
+  m_have_good(false)
+{
+  /* No work: deferred to begin(). */
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_Gate::begin(void)
+{
+  m_have_good = false;
+  m_stale = 0U;
+  m_cand_count = 0U;
+  (void)setSoundSpeed(m_inner.getSoundSpeed());
+  return m_inner.begin();
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_Gate::read(float &out_cm)
+{
+  HCSR04_GatedReading reading;
+  HCSR04_Status status = gate_(reading, false);
+
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeUsToCm_(reading.echo_us, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_Gate::readRawUs(unsigned long &out_echo_us)
+{
+  HCSR04_GatedReading reading;
+  const HCSR04_Status status = gate_(reading, false);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = reading.echo_us;
+  }
+
+  return status;
+}
+
+/* ============================ collectRawUs() ============================= */
+
+HCSR04_Status HCSR04_Gate::collectRawUs(unsigned long &out_echo_us)
+{
+  HCSR04_GatedReading reading;
+  const HCSR04_Status status = gate_(reading, true);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = reading.echo_us;
+  }
+
+  return status;
+}
+
+/* =========================== readQualified() ============================= */
+
+HCSR04_Status HCSR04_Gate::readQualified(HCSR04_GatedReading &out)
+{
+  return gate_(out, false);
+}
+
+/* ========================== setValidRangeMm() ============================ */
+
+HCSR04_Status HCSR04_Gate::setValidRangeMm(uint16_t min_mm, uint16_t max_mm)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if (min_mm < max_mm)
+  {
+    m_min_mm = min_mm;
+    m_max_mm = max_mm;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+/* ============================ setReacquire() ============================= */
+
+HCSR04_Status HCSR04_Gate::setReacquire(uint8_t count)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if (count != 0U)
+  {
+    m_reacquire = count;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+/* =============================== gate_() ================================= */
+
+HCSR04_Status HCSR04_Gate::gate_(HCSR04_GatedReading &out, bool collect)
+{
+  unsigned long echo_us = 0UL;
+  HCSR04_Status status = (collect == true) ? m_inner.collectRawUs(echo_us) : m_inner.readRawUs(echo_us);
+  const bool new_shot = ((status == HCSR04_OK) ||
+                         (status == HCSR04_ERR_TIMEOUT_ECHO_START) ||
+                         (status == HCSR04_ERR_TIMEOUT_ECHO_END) ||
+                         (status == HCSR04_ERR_OUT_OF_RANGE));
+
+  if (new_shot == true)
+  {
+    uint16_t mm = 0U;
+    bool candidate = false;
+
+    /* Range gate (echo times not representable in mm are out of range too). */
+    if ((status == HCSR04_OK) &&
+        ((timeUsToMm_(echo_us, mm) != HCSR04_OK) || (mm < m_min_mm) || (mm > m_max_mm)))
+    {
+      status = HCSR04_ERR_OUT_OF_RANGE;
+    }
+
+    /* Jump gate, bypassed until a good value exists. */
+    if ((status == HCSR04_OK) && (m_max_jump_mm != 0U) && (m_have_good == true))
+    {
+      const uint16_t jump = (mm > m_last_good_mm) ? static_cast<uint16_t>(mm - m_last_good_mm)
+                                                  : static_cast<uint16_t>(m_last_good_mm - mm);
+      if (jump > m_max_jump_mm)
+      {
+        /* Re-acquisition: m_reacquire rejections in a row, each close to the previous. */
+        const uint16_t step = (mm > m_cand_mm) ? static_cast<uint16_t>(mm - m_cand_mm)
+                                               : static_cast<uint16_t>(m_cand_mm - mm);
+        if ((m_cand_count != 0U) && (step <= m_max_jump_mm))
+        {
+          m_cand_count = (m_cand_count < 255U) ? static_cast<uint8_t>(m_cand_count + 1U) : m_cand_count;
+        }
+        else
+        {
+          m_cand_count = 1U;
+        }
+        m_cand_mm = mm;
+        candidate = true;
+        if (m_cand_count < m_reacquire)
+        {
+          status = HCSR04_ERR_IMPLAUSIBLE;
+        }
+      }
+    }
+
+    if ((candidate == false) || (status == HCSR04_OK))
+    {
+      m_cand_count = 0U;
+    }
+
+    out.raw_status = status;
+
+    if (status == HCSR04_OK)
+    {
+      m_last_good_us = echo_us;
+      m_last_good_mm = mm;
+      m_have_good = true;
+      m_stale = 0U;
+      out.quality = HCSR04_QUALITY_GOOD;
+    }
+    else
+    {
+      if (m_stale < 255U)
+      {
+        m_stale++;
+      }
+
+      if ((m_have_good == true) && (m_stale <= m_max_hold))
+      {
+        /* Hold-Last-Value. */
+        status = HCSR04_OK;
+        out.quality = HCSR04_QUALITY_HELD;
+      }
+      else
+      {
+        out.quality = HCSR04_QUALITY_INVALID;
+      }
+    }
+
+    out.distance_mm = m_last_good_mm;
+    out.echo_us = m_last_good_us;
+    out.stale = m_stale;
+  }
+
+  return status;
+}
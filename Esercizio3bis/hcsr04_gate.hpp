@@ -0,0 +1,158 @@
+/**
+ * @file hcsr04_gate.hpp
+ * @brief Range gating, jump rejection and Hold-Last-Value decorator for any IHCSR04.
+ * @version 1.1
+ * @date 2025-10-17
+ *
+ * HCSR04_Gate is itself an IHCSR04. Every shot of the wrapped driver is classified:
+ * - HCSR04_OK outside [min, max] valid range            -> HCSR04_ERR_OUT_OF_RANGE;
+ * - HCSR04_OK farther than max jump from the last good   -> HCSR04_ERR_IMPLAUSIBLE;
+ * - timeouts / out of range from the driver              -> passed through;
+ * - otherwise                                            -> HCSR04_QUALITY_GOOD.
+ * With Hold-Last-Value enabled a rejected shot returns the last good value as
+ * HCSR04_OK (quality HCSR04_QUALITY_HELD) for up to max_hold consecutive shots, then
+ * the error itself (quality HCSR04_QUALITY_INVALID). The jump gate is bypassed for the
+ * first good value. A real step is re-acquired when reacquire consecutive shots failed
+ * the jump gate but agree with each other (each within max jump of the previous one):
+ * the last of them is GOOD. This does not depend on the hold length, so a spike
+ * shorter than reacquire shots never passes (default 3: two-shot spikes are rejected).
+ * Any other outcome (good, timeout, out of range) restarts the count. Checked by
+ * tools/host/sim_gate.cpp.
+ * Statuses that mean "no new shot" (BUSY, NOT_READY, BAD_*) leave the gate untouched.
+ *
+ * readQualified() reports value, quality and staleness of every shot.
+ *
+ * Conversion uses this object's own Q16 scale (copied from the wrapped driver in the
+ * constructor and in begin()): apply setSoundSpeed()/setAirConditions() to the
+ * decorator. Timing (timeout, min cycle, max range) stays on the wrapped driver, and
+ * getLastShotTimestampUs() reports the wrapped driver's shots.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ */
+
+#ifndef HCSR04_GATE_HPP_
+#define HCSR04_GATE_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief Default valid range (mm, datasheet 2 cm .. 4 m). */
+#define HCSR04_GATE_MIN_MM            (20U)
+#define HCSR04_GATE_MAX_MM            (4000U)
+
+/** @brief Default consistent jump-gate rejections that re-acquire a new level. */
+#define HCSR04_GATE_REACQUIRE         (3U)
+
+/**
+ * @brief Quality of a gated reading.
+ */
+typedef enum
+{
+  HCSR04_QUALITY_GOOD = 0,  /**< Fresh measurement that passed every gate. */
+  HCSR04_QUALITY_HELD,      /**< Last good value repeated (current shot rejected). */
+  HCSR04_QUALITY_INVALID    /**< No usable value. */
+} HCSR04_Quality;
+
+/**
+ * @brief One gated reading.
+ */
+typedef struct
+{
+  uint16_t       distance_mm;  /**< Valid for GOOD and HELD. */
+  unsigned long  echo_us;      /**< Echo time behind distance_mm (GOOD and HELD). */
+  HCSR04_Quality quality;
+  uint8_t        stale;        /**< Consecutive shots since the last GOOD one (saturates). */
+  HCSR04_Status  raw_status;   /**< Classification of this shot before Hold-Last-Value. */
+} HCSR04_GatedReading;
+
+/**
+ * @class HCSR04_Gate
+ * @brief Plausibility gate with optional Hold-Last-Value output.
+ */
+class HCSR04_Gate : public IHCSR04
+{
+public:
+  /**
+   * @param inner Driver to gate (must outlive the decorator).
+   */
+  explicit HCSR04_Gate(IHCSR04 &inner);
+
+  virtual ~HCSR04_Gate() {}
+
+  /**
+   * @brief Start the wrapped driver and clear the gate history.
+   * @return Status of the wrapped driver's begin().
+   */
+  virtual HCSR04_Status begin(void);
+
+  /**
+   * @brief Gated read in centimeters.
+   * @return HCSR04_OK for GOOD and HELD readings, otherwise the classification status.
+   */
+  virtual HCSR04_Status read(float &out_cm);
+
+  /**
+   * @brief Gated read of the echo time.
+   * @return Same as read().
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief As readRawUs(), through the wrapped driver's collectRawUs() (no new shot).
+   * @return Same as read().
+   */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief Gated read with quality information.
+   * @param[out] out Filled for every new shot (quality INVALID when nothing usable).
+   * @return Same as read(); out is untouched when the driver made no new shot.
+   */
+  HCSR04_Status readQualified(HCSR04_GatedReading &out);
+
+  /** @brief Shot timestamp of the wrapped driver (the decorator never fires). */
+  virtual unsigned long getLastShotTimestampUs(void) const noexcept
+  {
+    return m_inner.getLastShotTimestampUs();
+  }
+
+  /**
+   * @brief Set the valid distance window.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM unless min_mm < max_mm).
+   */
+  HCSR04_Status setValidRangeMm(uint16_t min_mm, uint16_t max_mm);
+
+  /** @brief Largest accepted change from the last good value (mm, 0 disables). */
+  void setMaxJumpMm(uint16_t max_jump_mm) { m_max_jump_mm = max_jump_mm; }
+
+  /** @brief Shots a rejected reading is replaced by the last good one (0 disables). */
+  void setHoldLast(uint8_t max_hold) { m_max_hold = max_hold; }
+
+  /**
+   * @brief Consecutive, mutually consistent jump-gate rejections that re-acquire a step.
+   * @param count 1..255 (1: every jump is accepted at once).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on 0).
+   */
+  HCSR04_Status setReacquire(uint8_t count);
+
+private:
+  /* Classify one shot of the wrapped driver (collect: collectRawUs()) and apply
+     Hold-Last-Value. */
+  HCSR04_Status gate_(HCSR04_GatedReading &out, bool collect);
+
+  IHCSR04       &m_inner;
+  unsigned long  m_last_good_us;
+  uint16_t       m_last_good_mm;
+  uint16_t       m_min_mm;
+  uint16_t       m_max_mm;
+  uint16_t       m_max_jump_mm;
+  uint8_t        m_max_hold;
+  uint8_t        m_stale;
+  uint16_t       m_cand_mm;      /**< Last jump-gate rejection (re-acquisition candidate). */
+  uint8_t        m_cand_count;   /**< Consistent rejections in a row, 0: none. */
+  uint8_t        m_reacquire;
+  bool           m_have_good;
+};
+
+#endif /* HCSR04_GATE_HPP_ */
@@ -0,0 +1,237 @@
+/**
+ * @file hcsr04_input_capture.cpp
+ * @brief Implementation of HCSR04_InputCapture (non-blocking, Timer1 input capture).
+ * @version 1.0
+ * @date 2025-09-24
+ */
+
+#include "hcsr04_input_capture.hpp"
+
+/* ======== Static member definitions ====================================== */
+volatile uint8_t HCSR04_InputCapture::s_phase = HCSR04_InputCapture::ICP_IDLE;
+volatile uint16_t HCSR04_InputCapture::s_overflows = 0U;
+volatile unsigned long HCSR04_InputCapture::s_rise_ticks = 0UL;
+volatile unsigned long HCSR04_InputCapture::s_fall_ticks = 0UL;
+HCSR04_InputCapture* HCSR04_InputCapture::s_owner = 0;
+
+/* ============================= Constructor =============================== */
+
+HCSR04_InputCapture::HCSR04_InputCapture(uint8_t trig_pin,
+                                         uint8_t echo_pin,
+                                         unsigned long timeout_us,
+                                         float cm_per_us,
+                                         unsigned long min_cycle_us) :
+  IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us)
+{
+  /* No work: deferred to begin(). */
+}
+
+/* ============================= Destructor ================================ */
+
+HCSR04_InputCapture::~HCSR04_InputCapture()
+{
+  if (s_owner == this)
+  {
+    /* Release Timer1: interrupts masked, clock stopped, pending flags dropped. */
+    const uint8_t sreg = SREG;
+    cli();
+    TIMSK1 = 0U;
+    TCCR1B = 0U;
+    TIFR1 = static_cast<uint8_t>(_BV(ICF1) | _BV(TOV1));
+    s_phase = ICP_IDLE;
+    s_owner = 0;
+    SREG = sreg;
+  }
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_InputCapture::begin(void)
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  if (HCSR04_VECT_TIMER1 == 0)
+  {
+    /* Vectors compiled out (hcsr04_config.hpp): an enabled capture would reset the MCU. */
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if (getEchoPin() != HCSR04_ICP1_PIN)
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+  else if ((s_owner != 0) && (s_owner != this))
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else
+  {
+    /* Configure pins. */
+    pinMode(getTrigPin(), OUTPUT);
+    pinMode(getEchoPin(), INPUT);
+    digitalWrite(getTrigPin(), LOW);
+
+    const uint8_t sreg = SREG;
+    cli();
+    s_owner = this;
+    s_phase = ICP_IDLE;
+    s_overflows = 0U;
+
+    /* Timer1: normal mode, clk/1, noise canceler, capture on rising edge first. */
+    TCCR1A = 0U;
+    TCCR1B = static_cast<uint8_t>(_BV(ICNC1) | _BV(ICES1) | _BV(CS10));
+    TCCR1C = 0U;
+    TIFR1 = static_cast<uint8_t>(_BV(ICF1) | _BV(TOV1));
+    TIMSK1 = static_cast<uint8_t>(_BV(ICIE1) | _BV(TOIE1));
+    SREG = sreg;
+  }
+
+  return status;
+}
+
+/* ============================== collect_() =============================== */
+
+HCSR04_Status HCSR04_InputCapture::collect_(unsigned long &echo_high_ticks)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (s_owner == this)
+  {
+    /* s_phase is a single byte: reading it is atomic on AVR. */
+    const uint8_t phase = s_phase;
+    status = HCSR04_ERR_NOT_READY;
+
+    /* A finished (or expired) shot is always handed over before a new one may start,
+       however late read() is called. */
+    if (phase == ICP_DONE)
+    {
+      /* ISR is quiescent in ICP_DONE: 32-bit timestamps are stable. */
+      echo_high_ticks = s_fall_ticks - s_rise_ticks;
+      status = HCSR04_OK;
+      s_phase = ICP_IDLE;
+
+      /* Falling edge time in micros() is not latched: "now" is a conservative bound. */
+      noteEchoEnd_(micros());
+    }
+    else if (phase != ICP_IDLE)
+    {
+      if ((micros() - getLastShotTimestampUs()) >= getTimeoutUs())
+      {
+        status = echoTimeoutStatus_(phase == ICP_WAIT_FALL);
+        s_phase = ICP_IDLE;
+      }
+    }
+    /* Idle: start a shot once the cycle elapsed and ECHO is back low (a module still
+       finishing an early-closed window keeps it high). */
+    else if ((canStartShot_() == HCSR04_OK) && (digitalRead(getEchoPin()) == LOW))
+    {
+      /* Mark new shot. */
+      markShotStart_();
+
+      /* Re-arm capture on the rising edge (flag cleared after the edge select change). */
+      const uint8_t sreg = SREG;
+      cli();
+      TCCR1B |= static_cast<uint8_t>(_BV(ICES1));
+      TIFR1 = static_cast<uint8_t>(_BV(ICF1));
+      s_phase = ICP_WAIT_RISE;
+      SREG = sreg;
+
+      /* Generate TRIG pulse. */
+      trigPulse_();
+    }
+    else
+    {
+      /* Idle inside the cycle: nothing to report yet. */
+    }
+  }
+
+  return status;
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_InputCapture::read(float &out_cm)
+{
+  unsigned long echo_high_ticks = 0UL;
+  HCSR04_Status status = collect_(echo_high_ticks);
+
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeCyclesToCm_(echo_high_ticks, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_InputCapture::readRawUs(unsigned long &out_echo_us)
+{
+  unsigned long echo_high_ticks = 0UL;
+  HCSR04_Status status = collect_(echo_high_ticks);
+
+  if (status == HCSR04_OK)
+  {
+    /* Timer1 runs at F_CPU: round ticks to the nearest microsecond. */
+    const unsigned long ticks_per_us = static_cast<unsigned long>(clockCyclesPerMicrosecond());
+    out_echo_us = (echo_high_ticks + (ticks_per_us / 2UL)) / ticks_per_us;
+  }
+
+  return status;
+}
+
+/* =============================== ISRs ==================================== */
+
+void HCSR04_InputCapture::captureISR_(void)
+{
+  const uint16_t icr = ICR1;
+  uint16_t overflows = s_overflows;
+
+  /* Overflow pending but not yet serviced and capture taken just after the wrap. */
+  if (((TIFR1 & _BV(TOV1)) != 0U) && (icr < 0x8000U))
+  {
+    overflows++;
+  }
+
+  const unsigned long ticks = (static_cast<unsigned long>(overflows) << 16) | icr;
+
+  if (s_phase == ICP_WAIT_RISE)
+  {
+    s_rise_ticks = ticks;
+    TCCR1B &= static_cast<uint8_t>(~_BV(ICES1));
+    TIFR1 = static_cast<uint8_t>(_BV(ICF1));
+    s_phase = ICP_WAIT_FALL;
+  }
+  else if (s_phase == ICP_WAIT_FALL)
+  {
+    s_fall_ticks = ticks;
+    TCCR1B |= static_cast<uint8_t>(_BV(ICES1));
+    TIFR1 = static_cast<uint8_t>(_BV(ICF1));
+    s_phase = ICP_DONE;
+  }
+  else
+  {
+    /* Idle or result pending: ignore stray edges. */
+  }
+}
+
+void HCSR04_InputCapture::overflowISR_(void)
+{
+  s_overflows++;
+}
+
+#if (HCSR04_VECT_TIMER1 != 0)
+ISR(TIMER1_CAPT_vect)
+{
+  HCSR04_InputCapture::captureISR_();
+}
+
+ISR(TIMER1_OVF_vect)
+{
+  HCSR04_InputCapture::overflowISR_();
+}
+#endif /* HCSR04_VECT_TIMER1 */
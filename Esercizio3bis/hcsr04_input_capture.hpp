@@ -0,0 +1,104 @@
+/**
+ * @file hcsr04_input_capture.hpp
+ * @brief HC-SR04 ultrasonic sensor driver (Timer1 input capture) for Arduino UNO.
+ * @version 1.0
+ * @date 2025-09-24
+ *
+ * This concrete class derives from IHCSR04 and timestamps both ECHO edges in hardware
+ * with the ATmega328P Timer1 input-capture unit (ICP1 = D8):
+ * - Timer1 free-runs at F_CPU (prescaler 1): 62.5 ns resolution @16 MHz.
+ * - The input-capture noise canceler (ICNC1) is enabled; its fixed 4-cycle delay
+ *   applies to both edges and cancels out in the pulse width.
+ * - The capture ISR only latches ICR1 and flips the edge select (rising -> falling).
+ * - Timer1 overflows extend the 16-bit counter to 32 bits (echo > 4.096 ms).
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ * - Owns Timer1: incompatible with analogWrite() on D9/D10 and the Servo library.
+ *   Its TIMER1_CAPT/TIMER1_OVF vectors are compiled only with HCSR04_VECT_TIMER1 = 1
+ *   (hcsr04_config.hpp; default when HCSR04_DRIVER_SEL selects this driver). The
+ *   destructor stops the timer and masks both interrupts.
+ * - One instance per firmware image (there is a single ICP1 pin).
+ */
+
+#ifndef HCSR04_INPUT_CAPTURE_HPP_
+#define HCSR04_INPUT_CAPTURE_HPP_
+
+#include "hcsr04.hpp"
+#include "hcsr04_config.hpp"
+
+/** @brief Arduino UNO pin wired to ICP1 (PB0). */
+#define HCSR04_ICP1_PIN               (8U)
+
+/**
+ * @class HCSR04_InputCapture
+ * @brief Concrete Timer1 input-capture driver for HC-SR04 distance measurement.
+ */
+class HCSR04_InputCapture : public IHCSR04
+{
+public:
+  explicit HCSR04_InputCapture(uint8_t trig_pin,
+                               uint8_t echo_pin = HCSR04_ICP1_PIN,
+                               unsigned long timeout_us = HCSR04_DEFAULT_TIMEOUT_US,
+                               float cm_per_us = HCSR04_CM_PER_US,
+                               unsigned long min_cycle_us = HCSR04_DEFAULT_MIN_CYCLE_US);
+
+  virtual ~HCSR04_InputCapture();
+
+  /**
+   * @brief Configure pins and Timer1 (normal mode, prescaler 1, capture + overflow IRQs).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if ECHO is not D8,
+   *         HCSR04_ERR_BUSY if another instance already owns Timer1,
+   *         HCSR04_ERR_BAD_STATE if HCSR04_VECT_TIMER1 is 0).
+   */
+  virtual HCSR04_Status begin(void);
+
+  /**
+   * @brief Start a new measurement and return result if ready.
+   * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status
+   *
+   * @note Non-blocking: HCSR04_ERR_NOT_READY while the echo is in flight,
+   *       HCSR04_ERR_TIMEOUT_ECHO_START/END (or HCSR04_ERR_OUT_OF_RANGE with
+   *       setMaxRangeCm()) once the timeout window has elapsed. A finished shot is
+   *       returned by the next call however late it comes; that call does not start a
+   *       new shot (the following one does), so the timestamp matches the result.
+   */
+  virtual HCSR04_Status read(float &out_cm);
+
+  /**
+   * @brief As read(), reporting the echo high time rounded to microseconds.
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /* ISR hooks: public only so the vectors in the .cpp can reach them. */
+  static void captureISR_(void);
+  static void overflowISR_(void);
+
+private:
+  /* Shot start/collection shared by read() and readRawUs() (echo width in Timer1 ticks). */
+  HCSR04_Status collect_(unsigned long &echo_high_ticks);
+
+  /** @brief Capture state machine (written by ISR, reset by read()). */
+  typedef enum
+  {
+    ICP_IDLE = 0,
+    ICP_WAIT_RISE,
+    ICP_WAIT_FALL,
+    ICP_DONE
+  } IcpPhase;
+
+  /* Internal state machine. */
+  static volatile uint8_t s_phase;
+  static volatile uint16_t s_overflows;
+  static volatile unsigned long s_rise_ticks;
+  static volatile unsigned long s_fall_ticks;
+
+  /* Timer1 owner (single ICP1 unit). */
+  static HCSR04_InputCapture* s_owner;
+};
+
+#endif /* HCSR04_INPUT_CAPTURE_HPP_ */
@@ -1,17 +1,17 @@
 /**
  * @file hcsr04_interrupt.cpp
  * @brief Implementation of HCSR04_Interrupt (non-blocking, interrupt-based).
- * @version 1.0
- * @date 2025-09-17
+ * @version 1.4
+ * @date 2025-10-12
  */
 
 #include "hcsr04_interrupt.hpp"
 
+/* ======== Local constants ================================================= */
+static const uint8_t HCSR04_IRQ_UNBOUND = 0xFFU;
+
 /* ======== Static member definitions ====================================== */
-volatile bool HCSR04_Interrupt::s_waiting_rise = true;
-volatile unsigned long HCSR04_Interrupt::s_rise_us = 0UL;
-volatile unsigned long HCSR04_Interrupt::s_fall_us = 0UL;
-HCSR04_Interrupt* HCSR04_Interrupt::s_instance = 0;
+HCSR04_Interrupt* HCSR04_Interrupt::s_slots[HCSR04_INT_SLOTS] = { 0, 0 };
 
 /* ============================= Constructor =============================== */
 
@@ -20,7 +20,23 @@ HCSR04_Interrupt::HCSR04_Interrupt(uint8_t trig_pin,
                                    unsigned long timeout_us,
                                    float cm_per_us,
                                    unsigned long min_cycle_us) :
-  IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us)
+  IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us),
+  m_phase(IRQ_IDLE),
+  m_rise_us(0UL),
+  m_deadline_ticks(0U),
+  m_ring(),
+  m_last_edges(),
+  m_latest(),
+  m_seq(0U),
+  m_continuous(false),
+  m_cycle_ticks(0U),
+  m_cycle_reload(0U),
+  m_timeout_reload(0U),
+  m_trig_out(0),
+  m_echo_in(0),
+  m_trig_mask(0U),
+  m_echo_mask(0U),
+  m_irq(HCSR04_IRQ_UNBOUND)
 {
   /* No work: deferred to begin(). */
 }
@@ -29,8 +45,24 @@ HCSR04_Interrupt::HCSR04_Interrupt(uint8_t trig_pin,
 
 HCSR04_Interrupt::~HCSR04_Interrupt()
 {
-  detachInterrupt(digitalPinToInterrupt(getEchoPin()));
-  s_instance = 0;
+  if (m_irq != HCSR04_IRQ_UNBOUND)
+  {
+    detachInterrupt(m_irq);
+
+    const uint8_t sreg = SREG;
+    cli();
+    m_phase = IRQ_IDLE;
+    m_deadline_ticks = 0U;
+    m_continuous = false;
+    s_slots[m_irq] = 0;
+    if ((s_slots[0] == 0) && (s_slots[1] == 0))
+    {
+      /* Last instance gone: release Timer2. */
+      TIMSK2 &= static_cast<uint8_t>(~_BV(OCIE2A));
+      TCCR2B = 0U;
+    }
+    SREG = sreg;
+  }
 }
 
 /* ============================== begin() ================================== */
@@ -38,91 +70,386 @@ HCSR04_Interrupt::~HCSR04_Interrupt()
 HCSR04_Status HCSR04_Interrupt::begin(void)
 {
   HCSR04_Status status = HCSR04_OK;
+  const int irq = digitalPinToInterrupt(getEchoPin());
+
+  if (HCSR04_VECT_TIMER2 == 0)
+  {
+    /* Deadline vector compiled out (hcsr04_config.hpp): the tick would reset the MCU. */
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if ((irq < 0) || (irq >= static_cast<int>(HCSR04_INT_SLOTS)))
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+  else if ((s_slots[irq] != 0) && (s_slots[irq] != this))
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else
+  {
+    /* Configure pins. */
+    pinMode(getTrigPin(), OUTPUT);
+    pinMode(getEchoPin(), INPUT);
+    digitalWrite(getTrigPin(), LOW);
+
+    /* Resolve the ECHO fast path used by the trampolines and the ISR-side TRIG. */
+    m_trig_out = portOutputRegister(digitalPinToPort(getTrigPin()));
+    m_trig_mask = digitalPinToBitMask(getTrigPin());
+    m_echo_in = portInputRegister(digitalPinToPort(getEchoPin()));
+    m_echo_mask = digitalPinToBitMask(getEchoPin());
+    m_irq = static_cast<uint8_t>(irq);
 
-  /* Configure pins. */
-  pinMode(getTrigPin(), OUTPUT);
-  pinMode(getEchoPin(), INPUT);
-  digitalWrite(getTrigPin(), LOW);
+    const uint8_t sreg = SREG;
+    cli();
+    m_phase = IRQ_IDLE;
+    m_rise_us = 0UL;
+    m_deadline_ticks = 0U;
+    s_slots[m_irq] = this;
 
-  /* Register singleton instance for ISR. */
-  s_instance = this;
-  s_waiting_rise = true;
-  s_rise_us = 0UL;
-  s_fall_us = 0UL;
+    /* Timer2: CTC, clk/64, OCR2A=249 -> 1 ms compare match. Armed per shot only,
+       shared by all instances (TIMSK2 left as is: another instance may be armed). */
+    TCCR2A = static_cast<uint8_t>(_BV(WGM21));
+    TCCR2B = static_cast<uint8_t>(_BV(CS22));
+    OCR2A = HCSR04_DEADLINE_OCR2A;
+    SREG = sreg;
 
-  attachInterrupt(digitalPinToInterrupt(getEchoPin()), echoChangeISR_, CHANGE);
+    attachInterrupt(m_irq, (m_irq == 0U) ? echoISR0_ : echoISR1_, CHANGE);
+  }
 
   return status;
 }
 
-/* =============================== read() ================================== */
+/* ============================== collect_() =============================== */
 
-HCSR04_Status HCSR04_Interrupt::read(float &out_cm)
+HCSR04_Status HCSR04_Interrupt::collect_(HCSR04_Record &rec, bool fire)
 {
-  HCSR04_Status status = canStartShot_();
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (m_irq != HCSR04_IRQ_UNBOUND)
+  {
+    if ((m_continuous == false) && (m_phase == IRQ_IDLE))
+    {
+      /* Adaptive cycle: the falling edge of the last shot, if it completed. */
+      HCSR04_EdgePair edges;
+      if ((m_last_edges.read(edges) == true) &&
+          ((edges.rise_us - getLastShotTimestampUs()) < getTimeoutUs()))
+      {
+        noteEchoEnd_(edges.fall_us);
+      }
+    }
+
+    /* Continuous mode: the Timer2 tick owns TRIG, only fetch the newest sample. */
+    status = ((m_continuous == true) || (fire == false)) ? HCSR04_ERR_NOT_READY : canStartShot_();
+  }
+
+  if ((status == HCSR04_OK) && (m_phase != IRQ_IDLE))
+  {
+    /* Previous shot still in flight. */
+    status = HCSR04_ERR_BUSY;
+  }
+
+  if ((status == HCSR04_OK) && ((*m_echo_in & m_echo_mask) != 0U))
+  {
+    /* ECHO still high: the module is finishing a previous (early-closed) window. */
+    status = HCSR04_ERR_BUSY;
+  }
 
   if (status == HCSR04_OK)
   {
     /* Mark new shot. */
     markShotStart_();
 
-    /* Reset ISR state. */
-    s_waiting_rise = true;
-    s_rise_us = 0UL;
-    s_fall_us = 0UL;
+    /* Reset ISR state and arm the Timer2 deadline (rounded up to whole ticks). */
+    uint8_t ticks = ticksFor_(getTimeoutUs());
+    const uint8_t sreg = SREG;
+    cli();
+    if ((TIMSK2 & _BV(OCIE2A)) != 0U)
+    {
+      /* Timer2 already ticking for the other instance: the first tick is partial. */
+      if (ticks < 255U)
+      {
+        ticks++;
+      }
+    }
+    else
+    {
+      TCNT2 = 0U;
+      TIFR2 = static_cast<uint8_t>(_BV(OCF2A));
+    }
+    m_rise_us = 0UL;
+    m_deadline_ticks = ticks;
+    m_phase = IRQ_WAIT_RISE;
+    TIMSK2 |= static_cast<uint8_t>(_BV(OCIE2A));
+    SREG = sreg;
 
     /* Generate TRIG pulse. */
-    digitalWrite(getTrigPin(), LOW);
-    delayMicroseconds(2U);
-    digitalWrite(getTrigPin(), HIGH);
-    delayMicroseconds(HCSR04_TRIG_PULSE_US);
-    digitalWrite(getTrigPin(), LOW);
+    trigPulse_(m_trig_out, m_trig_mask);
   }
 
-  /* If rising and falling edges are captured, compute result. */
-  if ((s_rise_us != 0UL) && (s_fall_us != 0UL))
+  if (status != HCSR04_ERR_BAD_STATE)
   {
-    unsigned long echo_high_us = s_fall_us - s_rise_us;
-    float tmp_cm = 0.0F;
-    status = timeUsToCm_(echo_high_us, tmp_cm);
-    if (status == HCSR04_OK)
+    if (m_continuous == true)
     {
-      out_cm = tmp_cm;
+      HCSR04_Sample sample;
+      if (m_latest.read(sample) == true)
+      {
+        rec = sample.record;
+        status = rec.status;
+      }
+    }
+    else
+    {
+      status = (m_ring.pop(rec) == true) ? rec.status : HCSR04_ERR_NOT_READY;
     }
+  }
+
+  return status;
+}
+
+uint8_t HCSR04_Interrupt::ticksFor_(unsigned long us)
+{
+  const unsigned long ticks = (us + (HCSR04_DEADLINE_TICK_US - 1UL)) / HCSR04_DEADLINE_TICK_US;
+  return (ticks > 255UL) ? 255U : static_cast<uint8_t>(ticks);
+}
 
-    /* Reset for next shot. */
-    s_rise_us = 0UL;
-    s_fall_us = 0UL;
+/* =========================== setContinuous() ============================= */
+
+HCSR04_Status HCSR04_Interrupt::setContinuous(bool enable)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (m_irq != HCSR04_IRQ_UNBOUND)
+  {
+    const unsigned long max_us = 255UL * HCSR04_DEADLINE_TICK_US;
+    status = HCSR04_OK;
+
+    if ((enable == true) && ((getTimeoutUs() > max_us) || (getMinCycleUs() > max_us)))
+    {
+      status = HCSR04_ERR_BAD_PARAM;
+    }
+    else
+    {
+      const uint8_t sreg = SREG;
+      cli();
+      m_timeout_reload = ticksFor_(getTimeoutUs());
+      m_cycle_reload = ticksFor_(getMinCycleUs());
+      m_cycle_ticks = m_cycle_reload;
+      m_continuous = enable;
+      if ((enable == true) && ((TIMSK2 & _BV(OCIE2A)) == 0U))
+      {
+        TCNT2 = 0U;
+        TIFR2 = static_cast<uint8_t>(_BV(OCF2A));
+        TIMSK2 |= static_cast<uint8_t>(_BV(OCIE2A));
+      }
+      SREG = sreg;
+    }
   }
-  else
+
+  return status;
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_Interrupt::read(float &out_cm)
+{
+  HCSR04_Record rec;
+  HCSR04_Status status = collect_(rec, true);
+
+  if (status == HCSR04_OK)
+  {
+    status = recordToCm(rec, out_cm);
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_Interrupt::readRawUs(unsigned long &out_echo_us)
+{
+  HCSR04_Record rec;
+  const HCSR04_Status status = collect_(rec, true);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = rec.echo_us;
+  }
+
+  return status;
+}
+
+/* ============================ collectRawUs() ============================= */
+
+HCSR04_Status HCSR04_Interrupt::collectRawUs(unsigned long &out_echo_us)
+{
+  HCSR04_Record rec;
+  const HCSR04_Status status = collect_(rec, false);
+
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = rec.echo_us;
+  }
+
+  return status;
+}
+
+/* ============================= readBatch() =============================== */
+
+uint8_t HCSR04_Interrupt::readBatch(HCSR04_Record out[], uint8_t n)
+{
+  uint8_t count = 0U;
+  while ((count < n) && (m_ring.pop(out[count]) == true))
   {
-    status = HCSR04_ERR_NOT_READY;
+    count++;
   }
+  return count;
+}
 
+/* ============================ recordToCm() =============================== */
+
+HCSR04_Status HCSR04_Interrupt::recordToCm(const HCSR04_Record &rec, float &out_cm) const
+{
+  HCSR04_Status status = rec.status;
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeUsToCm_(rec.echo_us, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
   return status;
 }
 
-/* =============================== ISR ===================================== */
+/* =============================== ISRs ==================================== */
 
-void HCSR04_Interrupt::echoChangeISR_(void)
+void HCSR04_Interrupt::echoISR0_(void)
 {
-  const int level = digitalRead(s_instance->getEchoPin());
+  s_slots[0]->onEchoChange_();
+}
+
+void HCSR04_Interrupt::echoISR1_(void)
+{
+  s_slots[1]->onEchoChange_();
+}
+
+void HCSR04_Interrupt::onEchoChange_(void)
+{
+  const bool level_high = ((*m_echo_in & m_echo_mask) != 0U);
   const unsigned long now_us = micros();
 
-  if (s_waiting_rise == true)
+  if (m_phase == IRQ_WAIT_RISE)
   {
-    if (level == HIGH)
+    if (level_high == true)
     {
-      s_rise_us = now_us;
-      s_waiting_rise = false;
+      m_rise_us = now_us;
+      m_phase = IRQ_WAIT_FALL;
+    }
+  }
+  else if (m_phase == IRQ_WAIT_FALL)
+  {
+    if (level_high == false)
+    {
+      HCSR04_EdgePair edges;
+      edges.rise_us = m_rise_us;
+      edges.fall_us = now_us;
+      m_last_edges.write(edges);
+
+      m_deadline_ticks = 0U;
+      publish_(now_us - m_rise_us, HCSR04_OK);
     }
   }
   else
   {
-    if (level == LOW)
+    /* Idle or closed: ignore late/stray edges. */
+  }
+}
+
+void HCSR04_Interrupt::onDeadlineTick_(void)
+{
+  if (m_deadline_ticks != 0U)
+  {
+    m_deadline_ticks--;
+    if ((m_deadline_ticks == 0U) && (m_phase != IRQ_IDLE))
+    {
+      publish_(0UL, echoTimeoutStatus_(m_phase == IRQ_WAIT_FALL));
+    }
+  }
+
+  if (m_continuous == true)
+  {
+    if (m_cycle_ticks != 0U)
     {
-      s_fall_us = now_us;
-      s_waiting_rise = true;
+      m_cycle_ticks--;
+    }
+
+    /* Re-trigger once the min cycle elapsed, the shot closed and ECHO is back low. */
+    if ((m_cycle_ticks == 0U) && (m_phase == IRQ_IDLE) && ((*m_echo_in & m_echo_mask) == 0U))
+    {
+      startShotISR_();
     }
   }
-}
\ No newline at end of file
+}
+
+void HCSR04_Interrupt::startShotISR_(void)
+{
+  markShotStart_();
+  m_rise_us = 0UL;
+  m_deadline_ticks = m_timeout_reload;   /* Shot starts on a tick boundary: no partial tick. */
+  m_cycle_ticks = m_cycle_reload;
+  m_phase = IRQ_WAIT_RISE;
+
+  /* TRIG pulse on the cached port (interrupts already masked in ISR context). */
+  trigPulse_(m_trig_out, m_trig_mask);
+}
+
+void HCSR04_Interrupt::publish_(unsigned long echo_us, HCSR04_Status status)
+{
+  HCSR04_Record rec;
+  rec.shot_us = getLastShotTimestampUs();
+  rec.echo_us = echo_us;
+  rec.status = status;
+
+  /* Full ring: record dropped and counted by the ring itself. */
+  (void)m_ring.push(rec);
+
+  HCSR04_Sample sample;
+  m_seq++;
+  sample.record = rec;
+  sample.seq = m_seq;
+  m_latest.write(sample);
+
+  m_phase = IRQ_IDLE;
+}
+
+void HCSR04_Interrupt::deadlineISR_(void)
+{
+  bool armed = false;
+
+  for (uint8_t i = 0U; i < HCSR04_INT_SLOTS; i++)
+  {
+    HCSR04_Interrupt * const inst = s_slots[i];
+    if (inst != 0)
+    {
+      inst->onDeadlineTick_();
+      if ((inst->m_deadline_ticks != 0U) || (inst->m_continuous == true))
+      {
+        armed = true;
+      }
+    }
+  }
+
+  if (armed == false)
+  {
+    /* No shot in flight, no continuous instance: stop the 1 ms tick until re-armed. */
+    TIMSK2 &= static_cast<uint8_t>(~_BV(OCIE2A));
+  }
+}
+
+#if (HCSR04_VECT_TIMER2 != 0)
+ISR(TIMER2_COMPA_vect)
+{
+  HCSR04_Interrupt::deadlineISR_();
+}
+#endif /* HCSR04_VECT_TIMER2 */
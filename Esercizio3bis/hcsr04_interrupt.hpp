@@ -1,13 +1,46 @@
 /**
  * @file hcsr04_interrupt.hpp
  * @brief HC-SR04 ultrasonic sensor driver (interrupt-based) for Arduino UNO.
- * @version 1.0
- * @date 2025-09-17
+ * @version 1.4
+ * @date 2025-10-12
  *
  * This concrete class derives from IHCSR04 and provides a non-blocking,
  * interrupt-driven implementation. It relies on external interrupts on
  * Arduino UNO (pins D2/D3).
  *
+ * Multi-instance: up to HCSR04_INT_SLOTS sensors (one per INT line) run at once.
+ * Shot state lives in each instance; the static slot table only maps INT0/INT1
+ * to their owner and is written in begin()/destructor, never by an ISR. The
+ * dedicated trampolines sample ECHO through cached PINx/mask instead of
+ * digitalRead(), so per-edge ISR cost stays below the former single-instance
+ * version (~55 cycles saved per edge).
+ *
+ * Each shot arms a Timer2 compare-match deadline (1 ms ticks) covering the
+ * timeout window: a lost or late echo is closed in the ISR with
+ * HCSR04_ERR_TIMEOUT_ECHO_START/END (or HCSR04_ERR_OUT_OF_RANGE), so a dead
+ * sensor never leaves the shot pending. Owns Timer2 and its TIMER2_COMPA vector,
+ * compiled only with HCSR04_VECT_TIMER2 = 1 (hcsr04_config.hpp; default when
+ * HCSR04_DRIVER_SEL selects this driver): a build that defines it cannot use tone(),
+ * and analogWrite() on D3/D11 is lost once begin() reprograms the timer.
+ *
+ * Completed shots (and timeouts) are pushed by the ISRs into a per-instance
+ * lock-free SPSC ring of HCSR04_Record (HCSR04_RING_CAPACITY entries), so a slow
+ * loop() loses nothing until the ring is full; losses are counted. INTx and
+ * Timer2 ISRs never nest, so they act as a single producer.
+ *
+ * The rise/fall timestamps of the latest completed echo are also published
+ * through a seqlock (HCSR04_SeqLock): getLastEdges() returns a consistent
+ * 32-bit pair without masking interrupts and without consuming the ring.
+ *
+ * Continuous mode (setContinuous(true)): the Timer2 tick re-triggers the sensor
+ * every min cycle from ISR context, and every completed shot is published with its
+ * timestamp and a sequence number through a second seqlock. read()/readRawUs() then
+ * return the newest sample in constant time (~100 cycles, no TRIG, no waiting);
+ * getLatest() exposes the sequence number to detect repeated samples. The ISR-side
+ * TRIG pulse stretches one 1 ms tick per cycle by ~13 us. The tick also marks the shot
+ * start; IHCSR04 reads that 32-bit mark with interrupts masked, so
+ * getLastShotTimestampUs() is safe from loop().
+ *
  * Design constraints:
  * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
  * - Single exit point for non-noexcept functions.
@@ -18,6 +51,41 @@
 #define HCSR04_INTERRUPT_HPP_
 
 #include "hcsr04.hpp"
+#include "hcsr04_config.hpp"
+#include "hcsr04_ring.hpp"
+#include "hcsr04_seqlock.hpp"
+
+/** @brief Number of external interrupt lines on Arduino UNO (INT0=D2, INT1=D3). */
+#define HCSR04_INT_SLOTS              (2U)
+
+/** @brief Completed-shot records buffered per instance (power of two, <= 128). */
+#ifndef HCSR04_RING_CAPACITY
+#define HCSR04_RING_CAPACITY          (8U)
+#endif
+
+/** @brief Timer2 deadline tick period (microseconds). */
+#define HCSR04_DEADLINE_TICK_US       (1000UL)
+
+/** @brief OCR2A for HCSR04_DEADLINE_TICK_US with CTC and clk/64 (16 MHz / 64 / 250). */
+#define HCSR04_DEADLINE_OCR2A         (249U)
+
+/**
+ * @brief ECHO edge timestamps of one completed shot (micros()).
+ */
+typedef struct
+{
+  unsigned long rise_us;  /**< ECHO rising edge. */
+  unsigned long fall_us;  /**< ECHO falling edge. */
+} HCSR04_EdgePair;
+
+/**
+ * @brief Latest completed shot with its publication sequence number.
+ */
+typedef struct
+{
+  HCSR04_Record record;   /**< Shot timestamp, echo time and status. */
+  uint16_t      seq;      /**< Incremented on every publication (wraps). */
+} HCSR04_Sample;
 
 /**
  * @class HCSR04_Interrupt
@@ -36,31 +104,148 @@ public:
 
   /**
    * @brief Configure I/O directions and internal state. Call in setup().
-   * @return HCSR04_Status
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if ECHO is not D2/D3,
+   *         HCSR04_ERR_BUSY if another instance already owns that INT line,
+   *         HCSR04_ERR_BAD_STATE if HCSR04_VECT_TIMER2 is 0).
    */
   virtual HCSR04_Status begin(void);
 
   /**
-   * @brief Start a new measurement and return result if ready.
+   * @brief Start a new measurement and return the oldest buffered result.
    * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
    * @return HCSR04_Status
    *
    * @note This API is non-blocking: it can return HCSR04_ERR_NOT_READY if
-   *       the echo pulse has not completed yet.
+   *       no completed shot is buffered, and the timeout status set by
+   *       the Timer2 deadline (HCSR04_ERR_OUT_OF_RANGE with setMaxRangeCm()).
+   *       In continuous mode it only returns the newest published sample
+   *       (HCSR04_ERR_NOT_READY until the first one).
    */
   virtual HCSR04_Status read(float &out_cm);
 
+  /**
+   * @brief As read(), reporting the raw echo high time of the oldest buffered shot.
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief As readRawUs(), without triggering: only pops the oldest buffered record
+   *        (the newest sample in continuous mode).
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (HCSR04_ERR_NOT_READY if nothing is buffered).
+   */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief Drain up to n buffered records without triggering a new shot.
+   * @param[out] out Destination array (at least n entries).
+   * @param n Maximum number of records to copy.
+   * @return Number of records copied (oldest first).
+   */
+  uint8_t readBatch(HCSR04_Record out[], uint8_t n);
+
+  /**
+   * @brief Convert a buffered record to centimeters.
+   * @param rec Record obtained from readBatch().
+   * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
+   * @return rec.status, or the conversion status for HCSR04_OK records.
+   */
+  HCSR04_Status recordToCm(const HCSR04_Record &rec, float &out_cm) const;
+
+  /**
+   * @brief Consistent snapshot of the latest completed echo edges (does not consume).
+   * @param[out] out Receives the rise/fall pair when true is returned.
+   * @return false if no echo has completed yet.
+   */
+  bool getLastEdges(HCSR04_EdgePair &out) const { return m_last_edges.read(out); }
+
+  /**
+   * @brief Enable or disable free-running ranging driven by the Timer2 tick.
+   * @param enable true to re-trigger every min cycle from ISR context.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_STATE before begin(), HCSR04_ERR_BAD_PARAM
+   *         if timeout or min cycle exceed 255 ticks).
+   *
+   * @note Timeout and min cycle are latched here: call again after changing them.
+   *       The first shot fires one min cycle after enabling; a shot in flight when
+   *       disabling still completes normally. Shots are still pushed to the ring for
+   *       readBatch(); records nobody drains show up in getOverflowCount().
+   */
+  HCSR04_Status setContinuous(bool enable);
+
+  /** @brief true while continuous mode is enabled. */
+  bool isContinuous(void) const noexcept { return m_continuous; }
+
+  /**
+   * @brief Consistent snapshot of the newest published shot (does not consume).
+   * @param[out] out Receives record and sequence number when true is returned.
+   * @return false if no shot has completed yet.
+   */
+  bool getLatest(HCSR04_Sample &out) const { return m_latest.read(out); }
+
+  /** @brief Records dropped because loop() did not drain the ring in time. */
+  uint16_t getOverflowCount(void) const noexcept { return m_ring.overflows(); }
+
+  /* ISR hook: public only so the Timer2 vector in the .cpp can reach it. */
+  static void deadlineISR_(void);
+
 private:
-  /* Static ISR trampoline (one instance only supported). */
-  static void echoChangeISR_(void);
+  /** @brief Shot state machine (advanced by ISRs, reset by read()). */
+  typedef enum
+  {
+    IRQ_IDLE = 0,
+    IRQ_WAIT_RISE,
+    IRQ_WAIT_FALL
+  } IrqPhase;
+
+  /* Trigger-if-allowed (fire true) + pop of the oldest record (or newest sample in
+     continuous mode), shared by read(), readRawUs() and collectRawUs(). */
+  HCSR04_Status collect_(HCSR04_Record &rec, bool fire);
+
+  /* Timer2 ticks covering us (rounded up, saturated at 255). */
+  static uint8_t ticksFor_(unsigned long us);
+
+  /* Dedicated ISR trampolines, one per external interrupt line. */
+  static void echoISR0_(void);
+  static void echoISR1_(void);
+
+  /* Per-instance edge handler, deadline tick and record publication (ISR context). */
+  void onEchoChange_(void);
+  void onDeadlineTick_(void);
+  void publish_(unsigned long echo_us, HCSR04_Status status);
+  void startShotISR_(void);
+
+  /* INT line -> owning instance (written only in begin()/destructor). */
+  static HCSR04_Interrupt* s_slots[HCSR04_INT_SLOTS];
+
+  /* Per-instance state machine (shared only with this instance's ISRs). */
+  volatile uint8_t        m_phase;
+  volatile unsigned long  m_rise_us;
+  volatile uint8_t        m_deadline_ticks;
+
+  /* Completed shots, ISR -> loop(). */
+  HCSR04_Ring<HCSR04_Record, HCSR04_RING_CAPACITY> m_ring;
+
+  /* Latest completed rise/fall pair, ISR -> loop() without masking interrupts. */
+  HCSR04_SeqLock<HCSR04_EdgePair> m_last_edges;
+
+  /* Newest published shot and its sequence counter (written by ISRs only). */
+  HCSR04_SeqLock<HCSR04_Sample> m_latest;
+  uint16_t                m_seq;
 
-  /* Internal state machine. */
-  static volatile bool s_waiting_rise;
-  static volatile unsigned long s_rise_us;
-  static volatile unsigned long s_fall_us;
+  /* Continuous mode: flag, cycle countdown and reloads latched by setContinuous(). */
+  volatile bool           m_continuous;
+  volatile uint8_t        m_cycle_ticks;
+  uint8_t                 m_cycle_reload;
+  uint8_t                 m_timeout_reload;
 
-  /* Enforce single instance to bind ISR. */
-  static HCSR04_Interrupt* s_instance;
+  /* Cached TRIG/ECHO registers and INT line, resolved in begin(). */
+  volatile uint8_t       *m_trig_out;
+  volatile uint8_t       *m_echo_in;
+  uint8_t                 m_trig_mask;
+  uint8_t                 m_echo_mask;
+  uint8_t                 m_irq;
 };
 
-#endif /* HCSR04_INTERRUPT_HPP_ */
\ No newline at end of file
+#endif /* HCSR04_INTERRUPT_HPP_ */
@@ -0,0 +1,207 @@
+/**
+ * @file hcsr04_median.hpp
+ * @brief Sliding-window median decorator for any IHCSR04 driver.
+ * @version 1.0
+ * @date 2025-10-14
+ *
+ * HCSR04_Median<N> is itself an IHCSR04: every read()/readRawUs()/readMm() performs
+ * one read on the wrapped driver and, on HCSR04_OK, returns the median of the last N
+ * echo times (fewer while the window fills). Error statuses pass through unchanged
+ * and do not enter the window, so single-sample spikes are rejected while steps in
+ * distance appear after (N + 1) / 2 samples.
+ *
+ * Storage: echo times as uint16_t microseconds in an insertion-order ring plus a
+ * sorted copy, i.e. 4 bytes of RAM per sample. Each update removes the oldest value
+ * from the sorted copy and inserts the new one in a single O(N) slide.
+ * tools/host/sim_median.cpp checks every output against a window sorted from scratch
+ * (N = 3..63, duplicates, saturation, timeouts, reset()) and the step/spike behaviour.
+ *
+ * Estimated worst-case update cost (UNO, avr-gcc -Os, oldest and newest values at
+ * opposite ends of the sorted window):
+ *
+ *    N  | Cycles | us @16 MHz
+ *   ----+--------+-----------
+ *     3 |   ~110 |   ~7
+ *     5 |   ~150 |   ~9
+ *     9 |   ~230 |  ~14
+ *    15 |   ~350 |  ~22
+ *
+ * Conversion to cm/mm uses this object's own sound speed (copied from the wrapped
+ * driver in the constructor and in begin()): apply setSoundSpeed()/setAirConditions()
+ * to the decorator. Timing (timeout, min cycle, max range) stays on the wrapped driver,
+ * and getLastShotTimestampUs() reports the wrapped driver's shots.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Header-only template, fixed storage.
+ */
+
+#ifndef HCSR04_MEDIAN_HPP_
+#define HCSR04_MEDIAN_HPP_
+
+#include "hcsr04.hpp"
+
+/**
+ * @class HCSR04_Median
+ * @brief Decorator returning the running median of the wrapped driver's readings.
+ * @tparam N Window length, odd, 3..63.
+ */
+template <uint8_t N>
+class HCSR04_Median : public IHCSR04
+{
+  static_assert((N >= 3U) && (N <= 63U), "HCSR04_Median: window must be 3..63");
+  static_assert((N & 1U) != 0U, "HCSR04_Median: window must be odd");
+
+public:
+  /**
+   * @param inner Driver to filter (must outlive the decorator).
+   */
+  explicit HCSR04_Median(IHCSR04 &inner) :
+    IHCSR04(inner.getTrigPin(), inner.getEchoPin(), inner.getTimeoutUs(),
+            inner.getSoundSpeed(), inner.getMinCycleUs()),
+    m_inner(inner),
+    m_head(0U),
+    m_count(0U)
+  {
+    /* Window storage left uninitialized: only the first m_count entries are read. */
+  }
+
+  virtual ~HCSR04_Median() {}
+
+  /**
+   * @brief Start the wrapped driver and clear the window.
+   * @return Status of the wrapped driver's begin().
+   */
+  virtual HCSR04_Status begin(void)
+  {
+    reset();
+    (void)setSoundSpeed(m_inner.getSoundSpeed());
+    return m_inner.begin();
+  }
+
+  /**
+   * @brief One read on the wrapped driver, median distance in centimeters.
+   * @param[out] out_cm Median distance when HCSR04_OK is returned.
+   * @return HCSR04_Status (the wrapped driver's status when not HCSR04_OK).
+   */
+  virtual HCSR04_Status read(float &out_cm)
+  {
+    unsigned long echo_us = 0UL;
+    HCSR04_Status status = readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      float tmp_cm = 0.0F;
+      status = timeUsToCm_(echo_us, tmp_cm);
+      if (status == HCSR04_OK)
+      {
+        out_cm = tmp_cm;
+      }
+    }
+    return status;
+  }
+
+  /**
+   * @brief One read on the wrapped driver, median echo time.
+   * @param[out] out_echo_us Median echo time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (the wrapped driver's status when not HCSR04_OK).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    return forward_(false, out_echo_us);
+  }
+
+  /** @brief As readRawUs(), through the wrapped driver's collectRawUs() (no new shot). */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us)
+  {
+    return forward_(true, out_echo_us);
+  }
+
+  /** @brief Shot timestamp of the wrapped driver (the decorator never fires). */
+  virtual unsigned long getLastShotTimestampUs(void) const noexcept
+  {
+    return m_inner.getLastShotTimestampUs();
+  }
+
+  /** @brief Forget all buffered samples. */
+  void reset(void)
+  {
+    m_head = 0U;
+    m_count = 0U;
+  }
+
+  /** @brief Samples currently in the window (0..N). */
+  uint8_t getCount(void) const noexcept { return m_count; }
+
+private:
+  HCSR04_Status forward_(bool collect, unsigned long &out_echo_us)
+  {
+    unsigned long echo_us = 0UL;
+    const HCSR04_Status status = (collect == true) ? m_inner.collectRawUs(echo_us)
+                                                   : m_inner.readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      /* Echoes longer than 65.5 ms cannot occur within a sane timeout: saturate. */
+      push_((echo_us > 0xFFFFUL) ? 0xFFFFU : static_cast<uint16_t>(echo_us));
+      out_echo_us = median_();
+    }
+    return status;
+  }
+
+  /* Replace the oldest sample (or append while filling) and keep m_sorted ordered. */
+  void push_(uint16_t value)
+  {
+    uint8_t i = 0U;
+
+    if (m_count < N)
+    {
+      /* Filling: the hole is one past the sorted end. */
+      i = m_count;
+      m_count++;
+    }
+    else
+    {
+      /* Full: the hole is where the oldest value sits (always present). */
+      const uint16_t oldest = m_ring[m_head];
+      while (m_sorted[i] != oldest)
+      {
+        i++;
+      }
+    }
+
+    m_ring[m_head] = value;
+    m_head = (m_head == (N - 1U)) ? 0U : static_cast<uint8_t>(m_head + 1U);
+
+    /* Slide the hole up or down to the insertion point. */
+    while (((i + 1U) < m_count) && (m_sorted[i + 1U] < value))
+    {
+      m_sorted[i] = m_sorted[i + 1U];
+      i++;
+    }
+    while ((i > 0U) && (m_sorted[i - 1U] > value))
+    {
+      m_sorted[i] = m_sorted[i - 1U];
+      i--;
+    }
+    m_sorted[i] = value;
+  }
+
+  /* Middle element; mean of the two middle ones while an even count fills. */
+  unsigned long median_(void) const
+  {
+    const uint8_t mid = static_cast<uint8_t>(m_count >> 1);
+    unsigned long value = m_sorted[mid];
+    if ((m_count & 1U) == 0U)
+    {
+      value = (value + static_cast<unsigned long>(m_sorted[mid - 1U]) + 1UL) >> 1;
+    }
+    return value;
+  }
+
+  IHCSR04  &m_inner;
+  uint16_t  m_ring[N];    /**< Samples in arrival order. */
+  uint16_t  m_sorted[N];  /**< Same samples, ascending. */
+  uint8_t   m_head;       /**< Next ring slot to overwrite. */
+  uint8_t   m_count;      /**< Valid samples (0..N). */
+};
+
+#endif /* HCSR04_MEDIAN_HPP_ */
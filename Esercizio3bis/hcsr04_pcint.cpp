@@ -0,0 +1,246 @@
+/**
+ * @file hcsr04_pcint.cpp
+ * @brief Implementation of HCSR04_PCInt (non-blocking, pin-change interrupts).
+ * @version 1.0
+ * @date 2025-09-29
+ */
+
+#include "hcsr04_pcint.hpp"
+
+/* ======== Local constants ================================================= */
+static const uint8_t HCSR04_PCINT_UNBOUND = 0xFFU;
+
+/* ======== Static member definitions ====================================== */
+HCSR04_PCInt* HCSR04_PCInt::s_slots[HCSR04_PCINT_GROUPS][HCSR04_PCINT_LINES] = { { 0 } };
+uint8_t HCSR04_PCInt::s_line_mask[HCSR04_PCINT_GROUPS] = { 0U, 0U, 0U };
+volatile uint8_t HCSR04_PCInt::s_prev_pins[HCSR04_PCINT_GROUPS] = { 0U, 0U, 0U };
+
+/* ============================= Constructor =============================== */
+
+HCSR04_PCInt::HCSR04_PCInt(uint8_t trig_pin,
+                           uint8_t echo_pin,
+                           unsigned long timeout_us,
+                           float cm_per_us,
+                           unsigned long min_cycle_us) :
+  IHCSR04(trig_pin, echo_pin, timeout_us, cm_per_us, min_cycle_us),
+  m_phase(PCI_IDLE),
+  m_rise_us(0UL),
+  m_fall_us(0UL),
+  m_echo_in(0),
+  m_echo_mask(0U),
+  m_group(HCSR04_PCINT_UNBOUND)
+{
+  /* No work: deferred to begin(). */
+}
+
+/* ============================= Destructor ================================ */
+
+HCSR04_PCInt::~HCSR04_PCInt()
+{
+  if (m_group != HCSR04_PCINT_UNBOUND)
+  {
+    const uint8_t line = digitalPinToPCMSKbit(getEchoPin());
+    const uint8_t sreg = SREG;
+    cli();
+    *digitalPinToPCMSK(getEchoPin()) &= static_cast<uint8_t>(~m_echo_mask);
+    s_line_mask[m_group] &= static_cast<uint8_t>(~m_echo_mask);
+    s_slots[m_group][line] = 0;
+    if (s_line_mask[m_group] == 0U)
+    {
+      PCICR &= static_cast<uint8_t>(~_BV(m_group));
+    }
+    SREG = sreg;
+  }
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_PCInt::begin(void)
+{
+  HCSR04_Status status = HCSR04_OK;
+  volatile uint8_t * const pcicr = digitalPinToPCICR(getEchoPin());
+
+  if (HCSR04_VECT_PCINT == 0)
+  {
+    /* Vectors compiled out (hcsr04_config.hpp): an enabled PCINT would reset the MCU. */
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if ((pcicr == 0) || (digitalPinToPort(getEchoPin()) == NOT_A_PIN))
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+  else
+  {
+    const uint8_t group = digitalPinToPCICRbit(getEchoPin());
+    const uint8_t line = digitalPinToPCMSKbit(getEchoPin());
+
+    if ((s_slots[group][line] != 0) && (s_slots[group][line] != this))
+    {
+      status = HCSR04_ERR_BUSY;
+    }
+    else
+    {
+      /* Configure pins. */
+      pinMode(getTrigPin(), OUTPUT);
+      pinMode(getEchoPin(), INPUT);
+      digitalWrite(getTrigPin(), LOW);
+
+      m_echo_in = portInputRegister(digitalPinToPort(getEchoPin()));
+      m_echo_mask = digitalPinToBitMask(getEchoPin());
+      m_group = group;
+
+      const uint8_t sreg = SREG;
+      cli();
+      m_phase = PCI_IDLE;
+      s_slots[group][line] = this;
+      s_line_mask[group] |= m_echo_mask;
+      s_prev_pins[group] = *m_echo_in;
+      *digitalPinToPCMSK(getEchoPin()) |= m_echo_mask;
+      *pcicr |= static_cast<uint8_t>(_BV(group));
+      SREG = sreg;
+    }
+  }
+
+  return status;
+}
+
+/* ============================== collect_() =============================== */
+
+HCSR04_Status HCSR04_PCInt::collect_(unsigned long &echo_high_us)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (m_group != HCSR04_PCINT_UNBOUND)
+  {
+    /* m_phase is a single byte: reading it is atomic on AVR. */
+    const uint8_t phase = m_phase;
+    status = HCSR04_ERR_NOT_READY;
+
+    /* A finished (or expired) shot is always handed over before a new one may start,
+       however late read() is called. */
+    if (phase == PCI_DONE)
+    {
+      /* ISR ignores this line once done: timestamps are stable. */
+      echo_high_us = m_fall_us - m_rise_us;
+      noteEchoEnd_(m_fall_us);
+      status = HCSR04_OK;
+      m_phase = PCI_IDLE;
+    }
+    else if (phase != PCI_IDLE)
+    {
+      if ((micros() - getLastShotTimestampUs()) >= getTimeoutUs())
+      {
+        status = echoTimeoutStatus_(phase == PCI_WAIT_FALL);
+        m_phase = PCI_IDLE;
+      }
+    }
+    /* Idle: start a shot once the cycle elapsed and ECHO is back low (a module still
+       finishing an early-closed window keeps it high). */
+    else if ((canStartShot_() == HCSR04_OK) && ((*m_echo_in & m_echo_mask) == 0U))
+    {
+      /* Mark new shot. */
+      markShotStart_();
+      m_phase = PCI_WAIT_RISE;
+
+      /* Generate TRIG pulse. */
+      trigPulse_();
+    }
+    else
+    {
+      /* Idle inside the cycle: nothing to report yet. */
+    }
+  }
+
+  return status;
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_PCInt::read(float &out_cm)
+{
+  unsigned long echo_high_us = 0UL;
+  HCSR04_Status status = collect_(echo_high_us);
+
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeUsToCm_(echo_high_us, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_PCInt::readRawUs(unsigned long &out_echo_us)
+{
+  return collect_(out_echo_us);
+}
+
+/* =============================== ISRs ==================================== */
+
+void HCSR04_PCInt::onEdge_(bool level_high, unsigned long now_us)
+{
+  if ((m_phase == PCI_WAIT_RISE) && (level_high == true))
+  {
+    m_rise_us = now_us;
+    m_phase = PCI_WAIT_FALL;
+  }
+  else if ((m_phase == PCI_WAIT_FALL) && (level_high == false))
+  {
+    m_fall_us = now_us;
+    m_phase = PCI_DONE;
+  }
+  else
+  {
+    /* Idle, result pending or glitch: ignore. */
+  }
+}
+
+void HCSR04_PCInt::dispatchISR_(uint8_t group, uint8_t pins)
+{
+  /* One clock read for every edge decoded in this interrupt. */
+  const unsigned long now_us = micros();
+  uint8_t changed = static_cast<uint8_t>((pins ^ s_prev_pins[group]) & s_line_mask[group]);
+  uint8_t line = 0U;
+
+  s_prev_pins[group] = pins;
+
+  while (changed != 0U)
+  {
+    if ((changed & 0x01U) != 0U)
+    {
+      HCSR04_PCInt * const inst = s_slots[group][line];
+      if (inst != 0)
+      {
+        inst->onEdge_((pins & static_cast<uint8_t>(1U << line)) != 0U, now_us);
+      }
+    }
+    changed = static_cast<uint8_t>(changed >> 1);
+    line++;
+  }
+}
+
+#if (HCSR04_VECT_PCINT != 0)
+
+/* PINx is sampled first thing in each vector, before the timestamp. */
+ISR(PCINT0_vect)
+{
+  HCSR04_PCInt::dispatchISR_(0U, PINB);
+}
+
+ISR(PCINT1_vect)
+{
+  HCSR04_PCInt::dispatchISR_(1U, PINC);
+}
+
+ISR(PCINT2_vect)
+{
+  HCSR04_PCInt::dispatchISR_(2U, PIND);
+}
+
+#endif /* HCSR04_VECT_PCINT */
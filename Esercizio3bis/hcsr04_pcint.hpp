@@ -0,0 +1,120 @@
+/**
+ * @file hcsr04_pcint.hpp
+ * @brief HC-SR04 ultrasonic sensor driver (pin-change interrupts) for Arduino UNO.
+ * @version 1.0
+ * @date 2025-09-29
+ *
+ * This concrete class derives from IHCSR04 and timestamps ECHO edges from the
+ * pin-change interrupt of the port the ECHO pin belongs to, so any digital or
+ * analog pin can be used and many sensors can run on one board (8+).
+ *
+ * One ISR per port (PCINT0 = PORTB, PCINT1 = PORTC, PCINT2 = PORTD):
+ * - reads PINx once and micros() once;
+ * - XORs PINx with the previous snapshot to find every changed ECHO line;
+ * - hands the same timestamp to each changed line's instance.
+ *
+ * Estimated ISR cost (UNO @16 MHz, avr-gcc -Os): ~100 cycles fixed (prologue +
+ * micros()) + ~30 cycles per changed ECHO line, i.e. <= ~340 cycles (~21 us) with
+ * all 8 lines of a port changing in the same interrupt.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ * - Owns the PCINT0..2 vectors, compiled only with HCSR04_VECT_PCINT = 1
+ *   (hcsr04_config.hpp; default when HCSR04_DRIVER_SEL selects this driver):
+ *   incompatible with SoftwareSerial and other libraries defining them.
+ * - Timeouts are checked in read() against micros() (no hardware deadline).
+ */
+
+#ifndef HCSR04_PCINT_HPP_
+#define HCSR04_PCINT_HPP_
+
+#include "hcsr04.hpp"
+#include "hcsr04_config.hpp"
+
+/** @brief Number of pin-change interrupt groups on ATmega328P (PORTB, PORTC, PORTD). */
+#define HCSR04_PCINT_GROUPS           (3U)
+
+/** @brief Lines per pin-change group. */
+#define HCSR04_PCINT_LINES            (8U)
+
+/**
+ * @class HCSR04_PCInt
+ * @brief Concrete pin-change-interrupt driver for HC-SR04 distance measurement.
+ */
+class HCSR04_PCInt : public IHCSR04
+{
+public:
+  explicit HCSR04_PCInt(uint8_t trig_pin,
+                        uint8_t echo_pin,
+                        unsigned long timeout_us = HCSR04_DEFAULT_TIMEOUT_US,
+                        float cm_per_us = HCSR04_CM_PER_US,
+                        unsigned long min_cycle_us = HCSR04_DEFAULT_MIN_CYCLE_US);
+
+  virtual ~HCSR04_PCInt();
+
+  /**
+   * @brief Configure pins and enable the pin-change interrupt of ECHO. Call in setup().
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if ECHO has no PCINT line,
+   *         HCSR04_ERR_BUSY if another instance already owns that line,
+   *         HCSR04_ERR_BAD_STATE if HCSR04_VECT_PCINT is 0).
+   */
+  virtual HCSR04_Status begin(void);
+
+  /**
+   * @brief Start a new measurement and return result if ready.
+   * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status
+   *
+   * @note Non-blocking: HCSR04_ERR_NOT_READY while the echo is in flight,
+   *       HCSR04_ERR_TIMEOUT_ECHO_START/END (or HCSR04_ERR_OUT_OF_RANGE with
+   *       setMaxRangeCm()) once the timeout window has elapsed. A finished shot is
+   *       returned by the next call however late it comes; that call does not start a
+   *       new shot (the following one does), so the timestamp matches the result.
+   */
+  virtual HCSR04_Status read(float &out_cm);
+
+  /**
+   * @brief As read(), reporting the raw echo high time.
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as read()).
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /* ISR hook: public only so the PCINT vectors in the .cpp can reach it. */
+  static void dispatchISR_(uint8_t group, uint8_t pins);
+
+private:
+  /* Shot start/collection shared by read() and readRawUs(). */
+  HCSR04_Status collect_(unsigned long &echo_high_us);
+
+  /** @brief Shot state machine (advanced by the ISR, reset by read()). */
+  typedef enum
+  {
+    PCI_IDLE = 0,
+    PCI_WAIT_RISE,
+    PCI_WAIT_FALL,
+    PCI_DONE
+  } PciPhase;
+
+  /* Per-line edge handler (ISR context). */
+  void onEdge_(bool level_high, unsigned long now_us);
+
+  /* Group/line -> owning instance, enabled lines and last PINx per group
+     (tables written in begin()/destructor with interrupts masked). */
+  static HCSR04_PCInt* s_slots[HCSR04_PCINT_GROUPS][HCSR04_PCINT_LINES];
+  static uint8_t s_line_mask[HCSR04_PCINT_GROUPS];
+  static volatile uint8_t s_prev_pins[HCSR04_PCINT_GROUPS];
+
+  /* Per-instance state machine (shared only with the ISR). */
+  volatile uint8_t        m_phase;
+  volatile unsigned long  m_rise_us;
+  volatile unsigned long  m_fall_us;
+
+  /* ECHO line resolved in begin(). */
+  volatile uint8_t       *m_echo_in;
+  uint8_t                 m_echo_mask;
+  uint8_t                 m_group;
+};
+
+#endif /* HCSR04_PCINT_HPP_ */
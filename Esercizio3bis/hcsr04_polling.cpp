@@ -15,91 +15,362 @@
 HCSR04_Status HCSR04_Polling::begin(void)
 {
   HCSR04_Status status = HCSR04_OK;
+  const uint8_t trig_port = digitalPinToPort(getTrigPin());
+  const uint8_t echo_port = digitalPinToPort(getEchoPin());
 
-  /* Configure pin modes deterministically. */
-  pinMode(getTrigPin(), OUTPUT);
-  pinMode(getEchoPin(), INPUT);
+  m_trig_out = 0;
+  m_echo_in = 0;
 
-  /* Ensure TRIG is low before any shot (datasheet-friendly). */
-  digitalWrite(getTrigPin(), LOW);
+  if ((trig_port == NOT_A_PIN) || (echo_port == NOT_A_PIN))
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+  else
+  {
+    /* Configure pin modes deterministically. */
+    pinMode(getTrigPin(), OUTPUT);
+    pinMode(getEchoPin(), INPUT);
+
+    /* Ensure TRIG is low before any shot (datasheet-friendly). */
+    digitalWrite(getTrigPin(), LOW);
+
+    /* Resolve the port fast path once: no pin-table lookups inside read(). */
+    m_trig_out = portOutputRegister(trig_port);
+    m_trig_mask = digitalPinToBitMask(getTrigPin());
+    m_echo_in = portInputRegister(echo_port);
+    m_echo_mask = digitalPinToBitMask(getEchoPin());
+  }
 
   /* No hardware self-test here; consider adding a ping test if needed. */
   /* Single exit point. */
   return status;
 }
 
-/* =============================== read() ================================== */
+/* ============================= fireTrig_() ================================ */
 
-HCSR04_Status HCSR04_Polling::read(float &out_cm)
+HCSR04_Status HCSR04_Polling::fireTrig_(void)
 {
-  HCSR04_Status status = canStartShot_();
-  float tmp_cm = 0.0F;
+  HCSR04_Status status = HCSR04_OK;
 
+  if ((m_trig_out == 0) || (m_echo_in == 0))
+  {
+    /* begin() not called (or failed): no resolved registers to work with. */
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if ((m_phase == PHASE_WAIT_RISE) || (m_phase == PHASE_WAIT_FALL))
+  {
+    /* A split-phase shot is still in flight. */
+    status = HCSR04_ERR_BUSY;
+  }
+  /* ECHO still high: the module is finishing a previous (early-closed) window. */
+  else if ((*m_echo_in & m_echo_mask) != 0U)
+  {
+    status = HCSR04_ERR_BUSY;
+  }
   /* Enforce minimum cycle time between shots. */
-  if (canStartShot_() == HCSR04_OK)
+  else if (canStartShot_() != HCSR04_OK)
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else
   {
     /* Mark shot start (timestamp used by base for cycle control). */
     markShotStart_();
 
     /* Generate TRIG pulse: LOW (≥2 us) -> HIGH (HCSR04_TRIG_PULSE_US) -> LOW. */
-    digitalWrite(getTrigPin(), LOW);
-    delayMicroseconds(2U);
-    digitalWrite(getTrigPin(), HIGH);
-    delayMicroseconds(HCSR04_TRIG_PULSE_US);
-    digitalWrite(getTrigPin(), LOW);
+    trigPulse_(m_trig_out, m_trig_mask);
+  }
 
-    /* Wait for ECHO rising edge within timeout (referenced to t_start_us). */
-    const unsigned long t_start_us = micros();
-    const unsigned long timeout_us = getTimeoutUs();
+  return status;
+}
 
-    unsigned long t_rise_us = 0UL;
-    unsigned long now_us = micros();
+/* =============================== read() ================================== */
 
-    while (((now_us - t_start_us) < timeout_us) && (t_rise_us == 0UL))
+HCSR04_Status HCSR04_Polling::read(float &out_cm)
+{
+  float tmp_cm = 0.0F;
+  HCSR04_Status status = fireTrig_();
+
+  if (status == HCSR04_OK)
+  {
+    if (m_poll_mode == HCSR04_POLL_LOOP_COUNT)
     {
-      if (digitalRead(getEchoPin()) == HIGH)
+      unsigned long echo_high_cycles = 0UL;
+      status = measureLoopCount_(echo_high_cycles);
+      if (status == HCSR04_OK)
       {
-        t_rise_us = now_us;
+        status = timeCyclesToCm_(echo_high_cycles, tmp_cm);
+      }
+    }
+    else
+    {
+      unsigned long echo_high_us = 0UL;
+      status = measureMicros_(echo_high_us);
+      if (status == HCSR04_OK)
+      {
+        status = timeUsToCm_(echo_high_us, tmp_cm);
       }
-      now_us = micros();
     }
 
-    if (t_rise_us == 0UL)
+    if (status == HCSR04_OK)
     {
-      status = HCSR04_ERR_TIMEOUT_ECHO_START;
+      /* Falling edge was sampled just now: a few us late is conservative. */
+      noteEchoEnd_(micros());
+      out_cm = tmp_cm;
+    }
+  }
+
+  /* Single exit point. */
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_Polling::readRawUs(unsigned long &out_echo_us)
+{
+  unsigned long echo_high_us = 0UL;
+  HCSR04_Status status = fireTrig_();
+
+  if (status == HCSR04_OK)
+  {
+    if (m_poll_mode == HCSR04_POLL_LOOP_COUNT)
+    {
+      unsigned long echo_high_cycles = 0UL;
+      status = measureLoopCount_(echo_high_cycles);
+      /* Round cycles to the nearest microsecond (integer only). */
+      const unsigned long cycles_per_us = static_cast<unsigned long>(clockCyclesPerMicrosecond());
+      echo_high_us = (echo_high_cycles + (cycles_per_us / 2UL)) / cycles_per_us;
     }
     else
     {
-      /* Wait for ECHO falling edge using the SAME global timeout window. */
-      unsigned long t_fall_us = 0UL;
-      now_us = micros();
+      status = measureMicros_(echo_high_us);
+    }
 
-      while (((now_us - t_start_us) < timeout_us) && (t_fall_us == 0UL))
-      {
-        if (digitalRead(getEchoPin()) == LOW)
-        {
-          t_fall_us = now_us;
-        }
-        now_us = micros();
-      }
+    if (status == HCSR04_OK)
+    {
+      noteEchoEnd_(micros());
+      out_echo_us = echo_high_us;
+    }
+  }
+
+  /* Single exit point. */
+  return status;
+}
+
+/* ============================== trigger() ================================ */
+
+HCSR04_Status HCSR04_Polling::trigger(void)
+{
+  const HCSR04_Status status = fireTrig_();
+
+  if (status == HCSR04_OK)
+  {
+    m_t_start_us = micros();
+    m_t_rise_us = 0UL;
+    m_echo_high_us = 0UL;
+    m_result = HCSR04_ERR_NOT_READY;
+    m_phase = PHASE_WAIT_RISE;
+  }
+
+  return status;
+}
+
+/* ================================ poll() ================================= */
+
+HCSR04_Status HCSR04_Polling::poll(uint8_t max_samples)
+{
+  HCSR04_Status status = HCSR04_ERR_NOT_READY;
+  uint8_t samples = 0U;
+
+  while ((samples < max_samples) && ((m_phase == PHASE_WAIT_RISE) || (m_phase == PHASE_WAIT_FALL)))
+  {
+    const bool echo_high = ((*m_echo_in & m_echo_mask) != 0U);
+    const unsigned long now_us = micros();
+
+    if ((m_phase == PHASE_WAIT_RISE) && (echo_high == true))
+    {
+      m_t_rise_us = now_us;
+      m_phase = PHASE_WAIT_FALL;
+    }
+    else if ((m_phase == PHASE_WAIT_FALL) && (echo_high == false))
+    {
+      m_echo_high_us = now_us - m_t_rise_us;
+      noteEchoEnd_(now_us);
+      m_result = HCSR04_OK;
+      m_phase = PHASE_DONE;
+    }
+    /* Same global timeout window as read(). */
+    else if ((now_us - m_t_start_us) >= getTimeoutUs())
+    {
+      m_result = echoTimeoutStatus_(m_phase == PHASE_WAIT_FALL);
+      m_phase = PHASE_DONE;
+    }
+    else
+    {
+      /* No edge yet. */
+    }
+    samples++;
+  }
 
-      if (t_fall_us == 0UL)
+  if (m_phase == PHASE_DONE)
+  {
+    status = m_result;
+  }
+  else if (m_phase == PHASE_IDLE)
+  {
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else
+  {
+    /* Still in flight. */
+  }
+
+  return status;
+}
+
+/* =============================== result() ================================ */
+
+HCSR04_Status HCSR04_Polling::result(float &out_cm)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (m_phase == PHASE_DONE)
+  {
+    status = m_result;
+    if (status == HCSR04_OK)
+    {
+      float tmp_cm = 0.0F;
+      status = timeUsToCm_(m_echo_high_us, tmp_cm);
+      if (status == HCSR04_OK)
       {
-        status = HCSR04_ERR_TIMEOUT_ECHO_END;
+        out_cm = tmp_cm;
       }
-      else
+    }
+    m_phase = PHASE_IDLE;
+  }
+  else if (m_phase != PHASE_IDLE)
+  {
+    status = HCSR04_ERR_NOT_READY;
+  }
+  else
+  {
+    /* Nothing triggered. */
+  }
+
+  return status;
+}
+
+/* ============================ setPollMode() ============================== */
+
+HCSR04_Status HCSR04_Polling::setPollMode(HCSR04_PollMode mode)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if ((mode == HCSR04_POLL_MICROS) || (mode == HCSR04_POLL_LOOP_COUNT))
+  {
+    m_poll_mode = mode;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+/* ========================== measureMicros_() ============================= */
+
+HCSR04_Status HCSR04_Polling::measureMicros_(unsigned long &echo_high_us) const
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  /* Wait for ECHO rising edge within timeout (referenced to t_start_us). */
+  const unsigned long t_start_us = micros();
+  const unsigned long timeout_us = getTimeoutUs();
+
+  unsigned long t_rise_us = 0UL;
+  unsigned long now_us = micros();
+
+  while (((now_us - t_start_us) < timeout_us) && (t_rise_us == 0UL))
+  {
+    if ((*m_echo_in & m_echo_mask) != 0U)
+    {
+      t_rise_us = now_us;
+    }
+    now_us = micros();
+  }
+
+  if (t_rise_us == 0UL)
+  {
+    status = HCSR04_ERR_TIMEOUT_ECHO_START;
+  }
+  else
+  {
+    /* Wait for ECHO falling edge using the SAME global timeout window. */
+    unsigned long t_fall_us = 0UL;
+    now_us = micros();
+
+    while (((now_us - t_start_us) < timeout_us) && (t_fall_us == 0UL))
+    {
+      if ((*m_echo_in & m_echo_mask) == 0U)
       {
-        /* Compute high-time and convert to centimeters. */
-        const unsigned long echo_high_us = t_fall_us - t_rise_us;
-        status = timeUsToCm_(echo_high_us, tmp_cm);
-        if (status == HCSR04_OK)
-        {
-          out_cm = tmp_cm;
-        }
+        t_fall_us = now_us;
       }
+      now_us = micros();
+    }
+
+    if (t_fall_us == 0UL)
+    {
+      status = echoTimeoutStatus_(true);
+    }
+    else
+    {
+      echo_high_us = t_fall_us - t_rise_us;
+    }
+  }
+
+  return status;
+}
+
+/* ======================== measureLoopCount_() ============================ */
+
+HCSR04_Status HCSR04_Polling::measureLoopCount_(unsigned long &echo_high_cycles) const
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  /* Locals keep the loops free of member reloads: the per-iteration cost must stay
+     equal to HCSR04_LOOP_CYCLES_PER_ITER for the calibration to hold. */
+  volatile uint8_t * const echo_in = m_echo_in;
+  const uint8_t echo_mask = m_echo_mask;
+
+  /* Timeout as an iteration budget shared by both edges (same global window). */
+  unsigned long budget = (getTimeoutUs() * static_cast<unsigned long>(clockCyclesPerMicrosecond()))
+                         / HCSR04_LOOP_CYCLES_PER_ITER;
+
+  /* Wait for ECHO rising edge. */
+  while (((*echo_in & echo_mask) == 0U) && (budget != 0UL))
+  {
+    budget--;
+  }
+
+  if (budget == 0UL)
+  {
+    status = HCSR04_ERR_TIMEOUT_ECHO_START;
+  }
+  else
+  {
+    /* Wait for ECHO falling edge with an identical loop body. */
+    const unsigned long budget_at_rise = budget;
+
+    while (((*echo_in & echo_mask) != 0U) && (budget != 0UL))
+    {
+      budget--;
+    }
+
+    if (budget == 0UL)
+    {
+      status = echoTimeoutStatus_(true);
+    }
+    else
+    {
+      echo_high_cycles = (budget_at_rise - budget) * HCSR04_LOOP_CYCLES_PER_ITER;
     }
   }
 
-  /* Single exit point. */
   return status;
-}
\ No newline at end of file
+}
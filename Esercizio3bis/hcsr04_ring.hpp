@@ -0,0 +1,127 @@
+/**
+ * @file hcsr04_ring.hpp
+ * @brief Lock-free single-producer/single-consumer ring of HC-SR04 measurement records.
+ * @version 1.0
+ * @date 2025-10-01
+ *
+ * Intended for ISR -> loop() hand-off on 8-bit AVR:
+ * - The producer (ISR) and the consumer (loop()) each own one 8-bit index; byte
+ *   accesses are atomic on AVR, so neither side ever masks interrupts.
+ * - Indices free-run modulo 256 and are masked by (N - 1): N must be a power of two <= 128.
+ * - A full ring drops the NEW record and counts it, so published slots are never
+ *   overwritten while the consumer may be copying them.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Header-only template, fixed storage.
+ */
+
+#ifndef HCSR04_RING_HPP_
+#define HCSR04_RING_HPP_
+
+#include "hcsr04.hpp"
+
+/**
+ * @brief Raw measurement record produced in ISR context.
+ */
+typedef struct
+{
+  unsigned long shot_us;  /**< micros() at shot start (markShotStart_()). */
+  unsigned long echo_us;  /**< ECHO high time in microseconds (0 unless HCSR04_OK). */
+  HCSR04_Status status;   /**< HCSR04_OK or the timeout status that closed the shot. */
+} HCSR04_Record;
+
+/**
+ * @class HCSR04_Ring
+ * @brief Fixed-capacity SPSC ring buffer.
+ * @tparam T Element type (trivially copyable).
+ * @tparam N Capacity, power of two in 2..128.
+ */
+template <typename T, uint8_t N>
+class HCSR04_Ring
+{
+  static_assert((N >= 2U) && (N <= 128U), "HCSR04_Ring: capacity must be 2..128");
+  static_assert((N & (N - 1U)) == 0U, "HCSR04_Ring: capacity must be a power of two");
+
+public:
+  HCSR04_Ring() : m_head(0U), m_tail(0U), m_overflows(0U)
+  {
+    /* Storage left uninitialized: slots are written before being published. */
+  }
+
+  /**
+   * @brief Append one element (producer side only).
+   * @param item Element to copy into the ring.
+   * @return true if stored, false if the ring was full (overflow counted).
+   */
+  bool push(const T &item)
+  {
+    bool stored = false;
+    const uint8_t head = m_head;
+    if (static_cast<uint8_t>(head - m_tail) < N)
+    {
+      m_buf[head & (N - 1U)] = item;
+      HCSR04_COMPILER_BARRIER();
+      m_head = static_cast<uint8_t>(head + 1U);
+      stored = true;
+    }
+    else
+    {
+      m_overflows++;
+    }
+    return stored;
+  }
+
+  /**
+   * @brief Remove the oldest element (consumer side only).
+   * @param[out] item Receives the element when true is returned.
+   * @return true if an element was available.
+   */
+  bool pop(T &item)
+  {
+    bool taken = false;
+    const uint8_t tail = m_tail;
+    if (tail != m_head)
+    {
+      item = m_buf[tail & (N - 1U)];
+      HCSR04_COMPILER_BARRIER();
+      m_tail = static_cast<uint8_t>(tail + 1U);
+      taken = true;
+    }
+    return taken;
+  }
+
+  /** @brief Number of elements currently queued (consumer side). */
+  uint8_t size(void) const noexcept { return static_cast<uint8_t>(m_head - m_tail); }
+
+  /** @brief Capacity of the ring. */
+  uint8_t capacity(void) const noexcept { return N; }
+
+  /**
+   * @brief Records dropped because the ring was full (consumer side).
+   * @note 16-bit producer counter: re-read until stable instead of masking interrupts.
+   */
+  uint16_t overflows(void) const noexcept
+  {
+    uint16_t first = m_overflows;
+    uint16_t second = m_overflows;
+    while (first != second)
+    {
+      first = second;
+      second = m_overflows;
+    }
+    return second;
+  }
+
+  /* Non-copyable: owned by a single driver instance. */
+  HCSR04_Ring(const HCSR04_Ring&) = delete;
+  HCSR04_Ring& operator=(const HCSR04_Ring&) = delete;
+
+private:
+  T                 m_buf[N];
+  volatile uint8_t  m_head;       /**< Written by producer only. */
+  volatile uint8_t  m_tail;       /**< Written by consumer only. */
+  volatile uint16_t m_overflows;  /**< Written by producer only. */
+};
+
+#endif /* HCSR04_RING_HPP_ */
@@ -0,0 +1,352 @@
+/**
+ * @file hcsr04_shared_trig.cpp
+ * @brief Implementation of HCSR04_SharedTrig (one TRIG pulse, whole-port ECHO sampling).
+ * @version 1.0
+ * @date 2025-10-21
+ */
+
+#include "hcsr04_shared_trig.hpp"
+
+/* ============================= Constructor =============================== */
+
+HCSR04_SharedTrig::HCSR04_SharedTrig(uint8_t trig_pin,
+                                     const uint8_t *echo_pins,
+                                     uint8_t count,
+                                     unsigned long timeout_us,
+                                     float cm_per_us,
+                                     unsigned long min_cycle_us) :
+  IHCSR04(trig_pin, ((echo_pins != 0) && (count != 0U)) ? echo_pins[0] : 0U,
+          timeout_us, cm_per_us, min_cycle_us),
+  m_t_start_us(0UL),
+  m_trig_out(0),
+  m_echo_in(0),
+  m_trig_mask(0U),
+  m_echo_mask(0U),
+  m_wait_rise(0U),
+  m_wait_fall(0U),
+  m_count(0U),
+  m_in_flight(false)
+{
+  if ((echo_pins != 0) && (count <= HCSR04_SHARED_MAX_LINES))
+  {
+    m_count = count;
+  }
+  for (uint8_t i = 0U; i < HCSR04_SHARED_MAX_LINES; i++)
+  {
+    m_echo_pins[i] = (i < m_count) ? echo_pins[i] : 0U;
+    m_echo_bits[i] = 0U;
+    m_rise_us[i] = 0UL;
+    m_echo_us[i] = 0UL;
+    m_status[i] = HCSR04_ERR_NOT_READY;
+  }
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_SharedTrig::begin(void)
+{
+  HCSR04_Status status = HCSR04_OK;
+  const uint8_t trig_port = digitalPinToPort(getTrigPin());
+  const uint8_t echo_port = (m_count != 0U) ? digitalPinToPort(m_echo_pins[0]) : NOT_A_PIN;
+  uint8_t mask = 0U;
+
+  m_trig_out = 0;
+  m_echo_in = 0;
+
+  if ((trig_port == NOT_A_PIN) || (echo_port == NOT_A_PIN))
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+
+  for (uint8_t i = 0U; (i < m_count) && (status == HCSR04_OK); i++)
+  {
+    const uint8_t bit = digitalPinToBitMask(m_echo_pins[i]);
+    if ((digitalPinToPort(m_echo_pins[i]) != echo_port) || ((mask & bit) != 0U) ||
+        (m_echo_pins[i] == getTrigPin()))
+    {
+      status = HCSR04_ERR_BAD_PARAM;
+    }
+    else
+    {
+      m_echo_bits[i] = bit;
+      mask |= bit;
+    }
+  }
+
+  if (status == HCSR04_OK)
+  {
+    pinMode(getTrigPin(), OUTPUT);
+    digitalWrite(getTrigPin(), LOW);
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      pinMode(m_echo_pins[i], INPUT);
+    }
+
+    m_trig_out = portOutputRegister(trig_port);
+    m_trig_mask = digitalPinToBitMask(getTrigPin());
+    m_echo_in = portInputRegister(echo_port);
+    m_echo_mask = mask;
+    m_wait_rise = 0U;
+    m_wait_fall = 0U;
+    m_in_flight = false;
+  }
+
+  return status;
+}
+
+/* ============================== trigger() ================================ */
+
+HCSR04_Status HCSR04_SharedTrig::trigger(void)
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  if ((m_trig_out == 0) || (m_echo_in == 0))
+  {
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if (m_in_flight == true)
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  /* A module is still finishing a previous (early-closed) window. */
+  else if ((*m_echo_in & m_echo_mask) != 0U)
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else if (canStartShot_() != HCSR04_OK)
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else
+  {
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      m_status[i] = HCSR04_ERR_NOT_READY;
+    }
+    m_wait_rise = m_echo_mask;
+    m_wait_fall = 0U;
+    m_in_flight = true;
+
+    markShotStart_();
+    trigPulse_(m_trig_out, m_trig_mask);
+    m_t_start_us = micros();
+  }
+
+  return status;
+}
+
+/* ================================ poll() ================================= */
+
+HCSR04_Status HCSR04_SharedTrig::poll(uint8_t max_samples)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (m_in_flight == true)
+  {
+    uint8_t samples = 0U;
+    while ((samples < max_samples) && (m_in_flight == true))
+    {
+      sample_();
+      samples++;
+    }
+    status = (m_in_flight == true) ? HCSR04_ERR_NOT_READY : HCSR04_OK;
+  }
+  else if ((m_trig_out != 0) && (m_status[0] != HCSR04_ERR_NOT_READY))
+  {
+    /* Group already finished: results stay available. */
+    status = HCSR04_OK;
+  }
+  else
+  {
+    /* Nothing triggered. */
+  }
+
+  return status;
+}
+
+/* ============================== sample_() ================================ */
+
+void HCSR04_SharedTrig::sample_(void)
+{
+  /* PINx first, then one timestamp for every edge seen in this sample. */
+  const uint8_t pins = *m_echo_in;
+  const unsigned long now_us = micros();
+  const uint8_t rises = static_cast<uint8_t>(pins & m_wait_rise);
+  const uint8_t falls = static_cast<uint8_t>(static_cast<uint8_t>(~pins) & m_wait_fall);
+
+  if (static_cast<uint8_t>(rises | falls) != 0U)
+  {
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      if ((rises & m_echo_bits[i]) != 0U)
+      {
+        m_rise_us[i] = now_us;
+      }
+      else if ((falls & m_echo_bits[i]) != 0U)
+      {
+        m_echo_us[i] = now_us - m_rise_us[i];
+        m_status[i] = HCSR04_OK;
+      }
+      else
+      {
+        /* No edge on this line. */
+      }
+    }
+    m_wait_rise &= static_cast<uint8_t>(~rises);
+    m_wait_fall = static_cast<uint8_t>((m_wait_fall & static_cast<uint8_t>(~falls)) | rises);
+  }
+
+  /* Same global window as HCSR04_Polling: measured from the end of the TRIG pulse. */
+  if ((static_cast<uint8_t>(m_wait_rise | m_wait_fall) != 0U) &&
+      ((now_us - m_t_start_us) >= getTimeoutUs()))
+  {
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      if ((m_wait_rise & m_echo_bits[i]) != 0U)
+      {
+        m_status[i] = echoTimeoutStatus_(false);
+      }
+      else if ((m_wait_fall & m_echo_bits[i]) != 0U)
+      {
+        m_status[i] = echoTimeoutStatus_(true);
+      }
+      else
+      {
+        /* Already measured. */
+      }
+    }
+    m_wait_rise = 0U;
+    m_wait_fall = 0U;
+  }
+
+  if (static_cast<uint8_t>(m_wait_rise | m_wait_fall) == 0U)
+  {
+    bool all_ok = true;
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      if (m_status[i] != HCSR04_OK)
+      {
+        all_ok = false;
+      }
+    }
+    /* Adaptive cycle only when every module is known to be quiet. */
+    if (all_ok == true)
+    {
+      noteEchoEnd_(now_us);
+    }
+    m_in_flight = false;
+  }
+}
+
+/* ============================= readGroup() =============================== */
+
+HCSR04_Status HCSR04_SharedTrig::readGroup(void)
+{
+  HCSR04_Status status = trigger();
+
+  if (status == HCSR04_OK)
+  {
+    /* Bounded by the timeout check inside sample_(). */
+    while (poll() == HCSR04_ERR_NOT_READY)
+    {
+      /* Busy-wait. */
+    }
+  }
+
+  return status;
+}
+
+/* =============================== read() ================================== */
+
+HCSR04_Status HCSR04_SharedTrig::read(float &out_cm)
+{
+  unsigned long echo_us = 0UL;
+  HCSR04_Status status = readGroup();
+
+  if (status == HCSR04_OK)
+  {
+    status = nearest_(echo_us);
+  }
+  if (status == HCSR04_OK)
+  {
+    float tmp_cm = 0.0F;
+    status = timeUsToCm_(echo_us, tmp_cm);
+    if (status == HCSR04_OK)
+    {
+      out_cm = tmp_cm;
+    }
+  }
+
+  return status;
+}
+
+/* ============================= readRawUs() =============================== */
+
+HCSR04_Status HCSR04_SharedTrig::readRawUs(unsigned long &out_echo_us)
+{
+  unsigned long echo_us = 0UL;
+  HCSR04_Status status = readGroup();
+
+  if (status == HCSR04_OK)
+  {
+    status = nearest_(echo_us);
+  }
+  if (status == HCSR04_OK)
+  {
+    out_echo_us = echo_us;
+  }
+
+  return status;
+}
+
+/* ============================= getEchoUs() =============================== */
+
+HCSR04_Status HCSR04_SharedTrig::getEchoUs(uint8_t index, unsigned long &out_echo_us) const
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if (index < m_count)
+  {
+    status = m_status[index];
+    if (status == HCSR04_OK)
+    {
+      out_echo_us = m_echo_us[index];
+    }
+  }
+  return status;
+}
+
+/* =============================== getMm() ================================= */
+
+HCSR04_Status HCSR04_SharedTrig::getMm(uint8_t index, uint16_t &out_mm) const
+{
+  unsigned long echo_us = 0UL;
+  HCSR04_Status status = getEchoUs(index, echo_us);
+  if (status == HCSR04_OK)
+  {
+    status = timeUsToMm_(echo_us, out_mm);
+  }
+  return status;
+}
+
+/* ============================== nearest_() =============================== */
+
+HCSR04_Status HCSR04_SharedTrig::nearest_(unsigned long &echo_us) const
+{
+  HCSR04_Status status = (m_count != 0U) ? m_status[0] : HCSR04_ERR_BAD_STATE;
+  bool found = false;
+
+  for (uint8_t i = 0U; i < m_count; i++)
+  {
+    if ((m_status[i] == HCSR04_OK) && ((found == false) || (m_echo_us[i] < echo_us)))
+    {
+      echo_us = m_echo_us[i];
+      found = true;
+    }
+  }
+  if (found == true)
+  {
+    status = HCSR04_OK;
+  }
+
+  return status;
+}
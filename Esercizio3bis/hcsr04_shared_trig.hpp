@@ -0,0 +1,144 @@
+/**
+ * @file hcsr04_shared_trig.hpp
+ * @brief Group driver: up to 8 HC-SR04 on one TRIG pin, ECHO lines sampled as one port.
+ * @version 1.0
+ * @date 2025-10-21
+ *
+ * All modules of the group share one TRIG wire and are fired by a single pulse; their
+ * ECHO lines must sit on the same port (PORTB: D8..D13, PORTC: A0..A5, PORTD: D2..D7).
+ * Each sample reads PINx once and micros() once, masks it with the rise/fall wait sets and
+ * timestamps every line that changed, so the whole group completes within one echo
+ * window (timeout) instead of one window per sensor:
+ *
+ *   8 sensors, 60 ms min cycle   sequential read()   shared TRIG
+ *   sweep period                      480 ms             60 ms
+ *   TRIG pins used                      8                  1
+ *
+ * Estimated sample cost (UNO @16 MHz, avr-gcc -Os): ~75 cycles (~5 us) without
+ * edges, +~30 cycles per edge: edge timestamps are quantized to ~5 us (~1 mm).
+ *
+ * Modules fired together hear each other's bursts: group only sensors whose beams do
+ * not overlap (see the conflict rule of HCSR04_Array), otherwise a module may report
+ * its neighbour's shorter path.
+ *
+ * As an IHCSR04, read()/readRawUs() measure the whole group and report the nearest
+ * echo (one wide-beam sensor, e.g. a bumper); per-line results via getEchoUs()/getMm().
+ * Split-phase: trigger() + poll() as in HCSR04_Polling. tools/host/sim_shared_trig.cpp
+ * checks per-line results, the nearest echo and the group window on six modeled lines.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ * - No ISRs: whole-port polling only (the PCINT vectors belong to HCSR04_PCInt).
+ */
+
+#ifndef HCSR04_SHARED_TRIG_HPP_
+#define HCSR04_SHARED_TRIG_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief ECHO lines per group (one port). */
+#define HCSR04_SHARED_MAX_LINES       (8U)
+
+/** @brief Default maximum number of port samples taken by one poll() call. */
+#define HCSR04_SHARED_SAMPLES_PER_CALL (32U)
+
+/**
+ * @class HCSR04_SharedTrig
+ * @brief Shared-TRIG group of HC-SR04 modules with per-line echo capture.
+ */
+class HCSR04_SharedTrig : public IHCSR04
+{
+public:
+  /**
+   * @param trig_pin Common TRIG pin.
+   * @param echo_pins ECHO pins, 1..HCSR04_SHARED_MAX_LINES, all on one port (copied).
+   * @param count Number of entries in echo_pins.
+   */
+  explicit HCSR04_SharedTrig(uint8_t trig_pin,
+                             const uint8_t *echo_pins,
+                             uint8_t count,
+                             unsigned long timeout_us = HCSR04_DEFAULT_TIMEOUT_US,
+                             float cm_per_us = HCSR04_CM_PER_US,
+                             unsigned long min_cycle_us = HCSR04_DEFAULT_MIN_CYCLE_US);
+
+  virtual ~HCSR04_SharedTrig() {}
+
+  /**
+   * @brief Configure pins and resolve the ECHO port. Call in setup().
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on a bad count, on ECHO lines spread
+   *         over several ports, repeated or equal to TRIG).
+   */
+  virtual HCSR04_Status begin(void);
+
+  /**
+   * @brief Blocking group shot; nearest echo in centimeters.
+   * @return HCSR04_OK if any line measured, otherwise the status of line 0.
+   */
+  virtual HCSR04_Status read(float &out_cm);
+
+  /**
+   * @brief As read(), reporting the nearest raw echo high time.
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us);
+
+  /**
+   * @brief Blocking group shot: trigger() and poll() until every line finished.
+   * @return HCSR04_OK once per-line results are available, or the trigger() error.
+   */
+  HCSR04_Status readGroup(void);
+
+  /**
+   * @brief Fire the common TRIG pulse and return at once.
+   * @return HCSR04_Status (HCSR04_ERR_BUSY inside the min cycle, with a shot in flight or
+   *         with an ECHO line still high; HCSR04_ERR_BAD_STATE before begin()).
+   */
+  HCSR04_Status trigger(void);
+
+  /**
+   * @brief Take at most max_samples port samples.
+   * @return HCSR04_ERR_NOT_READY while any line is in flight, HCSR04_OK when the group
+   *         finished, HCSR04_ERR_BAD_STATE if nothing was triggered.
+   */
+  HCSR04_Status poll(uint8_t max_samples = HCSR04_SHARED_SAMPLES_PER_CALL);
+
+  /**
+   * @brief Echo time of one line of the current (or last) group shot.
+   * @return That line's status (HCSR04_ERR_BAD_PARAM on bad index,
+   *         HCSR04_ERR_NOT_READY until that line finished).
+   */
+  HCSR04_Status getEchoUs(uint8_t index, unsigned long &out_echo_us) const;
+
+  /**
+   * @brief Distance of one line of the current (or last) group shot (integer path).
+   * @return As getEchoUs(), or the conversion status.
+   */
+  HCSR04_Status getMm(uint8_t index, uint16_t &out_mm) const;
+
+  /** @brief Number of ECHO lines. */
+  uint8_t getCount(void) const noexcept { return m_count; }
+
+private:
+  /* One port sample: timestamp the lines that changed, close the window on timeout. */
+  void sample_(void);
+
+  /* Nearest OK line of the last finished shot (status of line 0 if none). */
+  HCSR04_Status nearest_(unsigned long &echo_us) const;
+
+  uint8_t                 m_echo_pins[HCSR04_SHARED_MAX_LINES];
+  uint8_t                 m_echo_bits[HCSR04_SHARED_MAX_LINES];  /**< Port bit per line. */
+  unsigned long           m_rise_us[HCSR04_SHARED_MAX_LINES];
+  unsigned long           m_echo_us[HCSR04_SHARED_MAX_LINES];
+  HCSR04_Status           m_status[HCSR04_SHARED_MAX_LINES];
+  unsigned long           m_t_start_us;
+  volatile uint8_t       *m_trig_out;
+  volatile uint8_t       *m_echo_in;
+  uint8_t                 m_trig_mask;
+  uint8_t                 m_echo_mask;   /**< All group lines. */
+  uint8_t                 m_wait_rise;   /**< Lines waiting for the rising edge. */
+  uint8_t                 m_wait_fall;   /**< Lines waiting for the falling edge. */
+  uint8_t                 m_count;
+  bool                    m_in_flight;
+};
+
+#endif /* HCSR04_SHARED_TRIG_HPP_ */
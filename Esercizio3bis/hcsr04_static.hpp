@@ -0,0 +1,301 @@
+/**
+ * @file hcsr04_static.hpp
+ * @brief HC-SR04 polling driver specialized at compile time (no virtual dispatch) for Arduino UNO.
+ * @version 1.0
+ * @date 2025-10-06
+ *
+ * For firmware whose pins and timing never change at run time:
+ * - TRIG/ECHO, timeout, min cycle and sound speed (Q16 mm/us) are template parameters;
+ * - pin -> PORTx/PINx/bit is resolved with constexpr, so TRIG/ECHO accesses compile
+ *   to single sbi/cbi/sbis instructions (atomic, no SREG save/restore);
+ * - the parameters IHCSR04's setters validate at run time are checked by static_assert;
+ * - the shared algorithm lives in a CRTP base (HCSR04_StaticBase) instead of a vtable.
+ *
+ * Footprint vs HCSR04_Polling (UNO, avr-gcc -Os, micros() timing). NOT MEASURED: these
+ * are estimates read off the source, not avr-size/avr-nm output, so the "measured
+ * flash/RAM saving" criterion of this driver is still open:
+ *   RAM per instance   ~50 bytes (vptr + runtime config + caches)  ->  4 bytes
+ *   ECHO sample        ~6 cycles (ld via pointer + and)            ->  1..2 cycles (sbis)
+ *   TRIG pulse         3 x (SREG save + cli + ld/or/st + restore)   ->  3 x sbi/cbi
+ *   readMm() call      virtual readRawUs() + runtime Q16 load      ->  inlined, constant Q16
+ * To measure: build two sketches identical except for the driver (a global
+ * HCSR04_Polling g(9U, 8U) or HCSR04_Static<9U, 8U> g; begin() in setup(), readMm() and
+ * Serial.println() in loop()), e.g. with arduino-cli compile -b arduino:avr:uno
+ * --build-path <dir>, then compare avr-size -A <dir>/<sketch>.ino.elf (.text/.data/.bss)
+ * and avr-nm -S --size-sort -C for the driver symbols.
+ *
+ * Usage:
+ *   static HCSR04_Static<9U, 8U> g_sonar;              // TRIG=D9, ECHO=D8, defaults
+ *   (void)g_sonar.begin();
+ *   uint16_t mm = 0U;
+ *   if (g_sonar.readMm(mm) == HCSR04_OK) { ... }
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Header-only, C++11 constexpr only (avr-gcc 7.3 / Arduino AVR core).
+ */
+
+#ifndef HCSR04_STATIC_HPP_
+#define HCSR04_STATIC_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief Default sound speed in Q16 mm per echo microsecond (0.0343 cm/us -> 0.1715 mm/us). */
+#define HCSR04_MM_PER_US_Q16          (11239U)
+
+/** @brief Q16 bounds matching setSoundSpeed()'s 0.02..0.06 cm/us plausibility window. */
+#define HCSR04_MM_PER_US_Q16_MIN      (6554U)
+#define HCSR04_MM_PER_US_Q16_MAX      (19661U)
+
+/** @brief Arduino UNO digital pins D0..D13 + A0..A5. */
+#define HCSR04_UNO_NUM_PINS           (20U)
+
+/** @brief Port identifiers used by the compile-time pin map. */
+#define HCSR04_UNO_PORT_B             (0U)
+#define HCSR04_UNO_PORT_C             (1U)
+#define HCSR04_UNO_PORT_D             (2U)
+
+/**
+ * @brief Compile-time Arduino UNO pin map (mirrors the core's PROGMEM tables).
+ * @tparam PIN Arduino pin number (0..19).
+ */
+template <uint8_t PIN>
+struct HCSR04_UnoPin
+{
+  static_assert(PIN < HCSR04_UNO_NUM_PINS, "HCSR04_UnoPin: Arduino UNO pins are 0..19");
+
+  static constexpr uint8_t port = (PIN < 8U) ? HCSR04_UNO_PORT_D
+                                             : ((PIN < 14U) ? HCSR04_UNO_PORT_B : HCSR04_UNO_PORT_C);
+  static constexpr uint8_t bit  = (PIN < 8U) ? PIN : ((PIN < 14U) ? (PIN - 8U) : (PIN - 14U));
+  static constexpr uint8_t mask = static_cast<uint8_t>(1U << bit);
+};
+
+/**
+ * @brief Register accessors per port (constant addresses -> sbi/cbi/sbis/sbic).
+ * @tparam PORT_ID One of HCSR04_UNO_PORT_B/C/D.
+ */
+template <uint8_t PORT_ID>
+struct HCSR04_UnoPort;
+
+template <>
+struct HCSR04_UnoPort<HCSR04_UNO_PORT_B>
+{
+  static volatile uint8_t &out(void) { return PORTB; }
+  static volatile uint8_t &in(void)  { return PINB; }
+  static volatile uint8_t &ddr(void) { return DDRB; }
+};
+
+template <>
+struct HCSR04_UnoPort<HCSR04_UNO_PORT_C>
+{
+  static volatile uint8_t &out(void) { return PORTC; }
+  static volatile uint8_t &in(void)  { return PINC; }
+  static volatile uint8_t &ddr(void) { return DDRC; }
+};
+
+template <>
+struct HCSR04_UnoPort<HCSR04_UNO_PORT_D>
+{
+  static volatile uint8_t &out(void) { return PORTD; }
+  static volatile uint8_t &in(void)  { return PIND; }
+  static volatile uint8_t &ddr(void) { return DDRD; }
+};
+
+/**
+ * @class HCSR04_StaticBase
+ * @brief CRTP base: measurement algorithm, statically bound to Derived's pin hooks.
+ *
+ * Derived must provide:
+ * - static constexpr unsigned long kTimeoutUs, kMinCycleUs; static constexpr uint16_t kMmPerUsQ16;
+ * - static void configurePins_(void), trigPulse_(void); static bool echoIsHigh_(void).
+ */
+template <class Derived>
+class HCSR04_StaticBase
+{
+public:
+  /**
+   * @brief Configure I/O directions. Call in setup().
+   * @return HCSR04_OK (parameters were validated at compile time).
+   */
+  HCSR04_Status begin(void)
+  {
+    Derived::configurePins_();
+    return HCSR04_OK;
+  }
+
+  /**
+   * @brief Blocking single shot reporting the raw ECHO high time.
+   * @param[out] out_echo_us Echo round-trip time in microseconds when HCSR04_OK is returned.
+   * @return HCSR04_Status (HCSR04_ERR_BUSY within the min cycle or while ECHO is high,
+   *         HCSR04_ERR_TIMEOUT_ECHO_START/END on timeout).
+   */
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    HCSR04_Status status = HCSR04_ERR_BUSY;
+
+    if ((Derived::echoIsHigh_() == false) && ((micros() - m_last_shot_us) >= Derived::kMinCycleUs))
+    {
+      m_last_shot_us = micros();
+      Derived::trigPulse_();
+
+      /* Wait for ECHO rising then falling edge in one global timeout window. */
+      const unsigned long t_start_us = micros();
+      unsigned long now_us = t_start_us;
+
+      while ((Derived::echoIsHigh_() == false) && ((now_us - t_start_us) < Derived::kTimeoutUs))
+      {
+        now_us = micros();
+      }
+
+      if (Derived::echoIsHigh_() == false)
+      {
+        status = HCSR04_ERR_TIMEOUT_ECHO_START;
+      }
+      else
+      {
+        const unsigned long t_rise_us = now_us;
+
+        while ((Derived::echoIsHigh_() == true) && ((now_us - t_start_us) < Derived::kTimeoutUs))
+        {
+          now_us = micros();
+        }
+
+        if (Derived::echoIsHigh_() == true)
+        {
+          status = HCSR04_ERR_TIMEOUT_ECHO_END;
+        }
+        else
+        {
+          out_echo_us = now_us - t_rise_us;
+          status = (out_echo_us != 0UL) ? HCSR04_OK : HCSR04_ERR_BAD_PARAM;
+        }
+      }
+    }
+
+    return status;
+  }
+
+  /**
+   * @brief Blocking single shot in millimeters (integer only, constant Q16 scale).
+   * @param[out] out_mm Distance in millimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as readRawUs()).
+   */
+  HCSR04_Status readMm(uint16_t &out_mm)
+  {
+    unsigned long echo_us = 0UL;
+    HCSR04_Status status = readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      if (echo_us <= (0xFFFF0000UL / Derived::kMmPerUsQ16))
+      {
+        out_mm = static_cast<uint16_t>(((echo_us * Derived::kMmPerUsQ16) + 0x8000UL) >> 16);
+      }
+      else
+      {
+        status = HCSR04_ERR_BAD_PARAM;
+      }
+    }
+    return status;
+  }
+
+  /**
+   * @brief Blocking single shot in centimeters (float, for drop-in use).
+   * @param[out] out_cm Distance in centimeters when HCSR04_OK is returned.
+   * @return HCSR04_Status (same semantics as readRawUs()).
+   */
+  HCSR04_Status read(float &out_cm)
+  {
+    unsigned long echo_us = 0UL;
+    const HCSR04_Status status = readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      /* Q16 mm/us -> float cm/us (folded to a constant). */
+      const float cm_per_us = static_cast<float>(Derived::kMmPerUsQ16) * (1.0F / (10.0F * 65536.0F));
+      out_cm = static_cast<float>(echo_us) * cm_per_us;
+    }
+    return status;
+  }
+
+  /** @brief Returns micros() timestamp of last shot start mark. */
+  unsigned long getLastShotTimestampUs(void) const noexcept { return m_last_shot_us; }
+
+protected:
+  HCSR04_StaticBase() : m_last_shot_us(0UL)
+  {
+    /* No dynamic work here. begin() configures the pins. */
+  }
+
+  HCSR04_StaticBase(const HCSR04_StaticBase&) = delete;
+  HCSR04_StaticBase& operator=(const HCSR04_StaticBase&) = delete;
+
+private:
+  unsigned long m_last_shot_us;
+};
+
+/**
+ * @class HCSR04_Static
+ * @brief Arduino UNO polling driver with pins and timing fixed at compile time.
+ * @tparam TRIG_PIN TRIG pin (OUTPUT).
+ * @tparam ECHO_PIN ECHO pin (INPUT).
+ * @tparam TIMEOUT_US Round-trip timeout in microseconds.
+ * @tparam MIN_CYCLE_US Minimum idle time between consecutive reads (us).
+ * @tparam MM_PER_US_Q16 Sound speed as Q16 millimeters per echo microsecond.
+ */
+template <uint8_t TRIG_PIN,
+          uint8_t ECHO_PIN,
+          unsigned long TIMEOUT_US = HCSR04_DEFAULT_TIMEOUT_US,
+          unsigned long MIN_CYCLE_US = HCSR04_DEFAULT_MIN_CYCLE_US,
+          uint16_t MM_PER_US_Q16 = HCSR04_MM_PER_US_Q16>
+class HCSR04_Static : public HCSR04_StaticBase<HCSR04_Static<TRIG_PIN, ECHO_PIN, TIMEOUT_US, MIN_CYCLE_US, MM_PER_US_Q16> >
+{
+  /* Same rules IHCSR04's setters enforce at run time. */
+  static_assert(TRIG_PIN != ECHO_PIN, "HCSR04_Static: TRIG and ECHO must differ (setTrigPin/setEchoPin)");
+  static_assert(TIMEOUT_US >= (HCSR04_TRIG_PULSE_US + 100UL), "HCSR04_Static: timeout too small (setTimeoutUs)");
+  static_assert(MIN_CYCLE_US != 0UL, "HCSR04_Static: min cycle must be non-zero (setMinCycleUs)");
+  static_assert((MM_PER_US_Q16 > HCSR04_MM_PER_US_Q16_MIN) && (MM_PER_US_Q16 < HCSR04_MM_PER_US_Q16_MAX),
+                "HCSR04_Static: sound speed outside 0.02..0.06 cm/us (setSoundSpeed)");
+
+  typedef HCSR04_UnoPin<TRIG_PIN> Trig;
+  typedef HCSR04_UnoPin<ECHO_PIN> Echo;
+  typedef HCSR04_UnoPort<Trig::port> TrigPort;
+  typedef HCSR04_UnoPort<Echo::port> EchoPort;
+
+  friend class HCSR04_StaticBase<HCSR04_Static>;
+
+public:
+  static constexpr unsigned long kTimeoutUs = TIMEOUT_US;
+  static constexpr unsigned long kMinCycleUs = MIN_CYCLE_US;
+  static constexpr uint16_t kMmPerUsQ16 = MM_PER_US_Q16;
+
+  HCSR04_Static() : HCSR04_StaticBase<HCSR04_Static>()
+  {
+    /* No work. Configuration is finalized in begin(). */
+  }
+
+private:
+  /* Single-bit RMW on constant I/O addresses: sbi/cbi, atomic without cli(). */
+  static void configurePins_(void)
+  {
+    TrigPort::out() &= static_cast<uint8_t>(~Trig::mask);
+    TrigPort::ddr() |= Trig::mask;
+    EchoPort::ddr() &= static_cast<uint8_t>(~Echo::mask);
+    EchoPort::out() &= static_cast<uint8_t>(~Echo::mask);
+  }
+
+  /* TRIG pulse: LOW (>=2 us) -> HIGH (HCSR04_TRIG_PULSE_US) -> LOW. */
+  static void trigPulse_(void)
+  {
+    TrigPort::out() &= static_cast<uint8_t>(~Trig::mask);
+    delayMicroseconds(2U);
+    TrigPort::out() |= Trig::mask;
+    delayMicroseconds(HCSR04_TRIG_PULSE_US);
+    TrigPort::out() &= static_cast<uint8_t>(~Trig::mask);
+  }
+
+  static bool echoIsHigh_(void)
+  {
+    return ((EchoPort::in() & Echo::mask) != 0U);
+  }
+};
+
+#endif /* HCSR04_STATIC_HPP_ */
@@ -0,0 +1,300 @@
+/**
+ * @file hcsr04_stats.hpp
+ * @brief Sliding-window statistics (mean, variance, min, max) decorator for any IHCSR04.
+ * @version 1.1
+ * @date 2025-10-15
+ *
+ * HCSR04_Stats<N> is itself an IHCSR04: reads are forwarded unchanged to the wrapped
+ * driver, and every HCSR04_OK distance (millimeters) also updates statistics over the
+ * last N samples. Each update is O(1) amortized and integer only:
+ * - mean and variance: exact running sum and sum of squares of the window (add new,
+ *   subtract oldest; 32 and 64 bit), turned into floats only by getStats(). Nothing
+ *   accumulates rounding, however long the decorator runs (a sliding float Welford M2
+ *   keeps the residue of busy stretches and reports it as variance of a still target);
+ * - min/max: monotonic deques of (value, sequence) pairs; a sample is pushed and
+ *   popped at most once per deque.
+ * tools/host/sim_stats.cpp checks every snapshot against the window recomputed from
+ * scratch, and a 5-million-sample run for drift.
+ *
+ * RAM: 8 bytes per sample (ring 2 + two deques 3 + 3) plus ~20 bytes.
+ * Estimated cost (UNO, avr-gcc -Os): ~120 cycles per update (16x16 square, 64-bit add
+ * and subtract), plus ~15 cycles per popped deque entry; getStats() ~1500 cycles
+ * (64-bit products, 3 soft-float operations).
+ *
+ * Conversion uses this object's own Q16 scale (copied from the wrapped driver in the
+ * constructor and in begin()): apply setSoundSpeed()/setAirConditions() to the
+ * decorator. Timing (timeout, min cycle, max range) stays on the wrapped driver, and
+ * getLastShotTimestampUs() reports the wrapped driver's shots.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Header-only templates, fixed storage.
+ */
+
+#ifndef HCSR04_STATS_HPP_
+#define HCSR04_STATS_HPP_
+
+#include "hcsr04.hpp"
+
+/**
+ * @brief Snapshot of the window statistics (millimeters).
+ */
+typedef struct
+{
+  uint8_t  count;        /**< Samples in the window (1..N). */
+  float    mean_mm;      /**< Arithmetic mean. */
+  float    variance_mm2; /**< Sample variance (n - 1), 0 with a single sample. */
+  uint16_t min_mm;       /**< Smallest sample. */
+  uint16_t max_mm;       /**< Largest sample. */
+} HCSR04_WindowStats;
+
+/**
+ * @class HCSR04_MonoDeque
+ * @brief Monotonic deque of (value, sequence) pairs for sliding min or max.
+ * @tparam N Capacity (window length).
+ */
+template <uint8_t N>
+class HCSR04_MonoDeque
+{
+public:
+  HCSR04_MonoDeque() : m_head(0U), m_size(0U)
+  {
+    /* Storage left uninitialized: only the first m_size entries from m_head are read. */
+  }
+
+  /**
+   * @brief Append a sample, dropping entries it dominates.
+   * @param value Sample value.
+   * @param seq Sample sequence number (wraps at 256).
+   * @param track_max true for a max deque (drop smaller or equal), false for min.
+   */
+  void push(uint16_t value, uint8_t seq, bool track_max)
+  {
+    while ((m_size != 0U) && dominates_(value, m_value[back_()], track_max))
+    {
+      m_size--;
+    }
+    const uint8_t slot = wrap_(static_cast<uint8_t>(m_head + m_size));
+    m_value[slot] = value;
+    m_seq[slot] = seq;
+    m_size++;
+  }
+
+  /**
+   * @brief Drop front entries older than the window.
+   * @param newest_seq Sequence number of the newest sample.
+   */
+  void expire(uint8_t newest_seq)
+  {
+    while ((m_size != 0U) && (static_cast<uint8_t>(newest_seq - m_seq[m_head]) >= N))
+    {
+      m_head = wrap_(static_cast<uint8_t>(m_head + 1U));
+      m_size--;
+    }
+  }
+
+  /** @brief Current extreme (deque must not be empty). */
+  uint16_t front(void) const noexcept { return m_value[m_head]; }
+
+  /** @brief Remove all entries. */
+  void clear(void)
+  {
+    m_head = 0U;
+    m_size = 0U;
+  }
+
+private:
+  static uint8_t wrap_(uint8_t index) { return (index >= N) ? static_cast<uint8_t>(index - N) : index; }
+
+  uint8_t back_(void) const { return wrap_(static_cast<uint8_t>(m_head + m_size - 1U)); }
+
+  static bool dominates_(uint16_t value, uint16_t other, bool track_max)
+  {
+    return (track_max == true) ? (value >= other) : (value <= other);
+  }
+
+  uint16_t m_value[N];
+  uint8_t  m_seq[N];
+  uint8_t  m_head;
+  uint8_t  m_size;
+};
+
+/**
+ * @class HCSR04_Stats
+ * @brief Decorator keeping O(1) sliding statistics of the wrapped driver's readings.
+ * @tparam N Window length, 2..128.
+ */
+template <uint8_t N>
+class HCSR04_Stats : public IHCSR04
+{
+  static_assert((N >= 2U) && (N <= 128U), "HCSR04_Stats: window must be 2..128");
+
+public:
+  /**
+   * @param inner Driver to monitor (must outlive the decorator).
+   */
+  explicit HCSR04_Stats(IHCSR04 &inner) :
+    IHCSR04(inner.getTrigPin(), inner.getEchoPin(), inner.getTimeoutUs(),
+            inner.getSoundSpeed(), inner.getMinCycleUs()),
+    m_inner(inner),
+    m_min(),
+    m_max(),
+    m_sum(0UL),
+    m_sum_sq(0ULL),
+    m_seq(0U),
+    m_head(0U),
+    m_count(0U)
+  {
+    /* Window storage left uninitialized: only the first m_count entries are read. */
+  }
+
+  virtual ~HCSR04_Stats() {}
+
+  /**
+   * @brief Start the wrapped driver and clear the statistics.
+   * @return Status of the wrapped driver's begin().
+   */
+  virtual HCSR04_Status begin(void)
+  {
+    reset();
+    (void)setSoundSpeed(m_inner.getSoundSpeed());
+    return m_inner.begin();
+  }
+
+  /**
+   * @brief Forwarded read (centimeters); HCSR04_OK results update the statistics.
+   * @param[out] out_cm Distance when HCSR04_OK is returned.
+   * @return Status of the wrapped driver.
+   */
+  virtual HCSR04_Status read(float &out_cm)
+  {
+    unsigned long echo_us = 0UL;
+    HCSR04_Status status = readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      float tmp_cm = 0.0F;
+      status = timeUsToCm_(echo_us, tmp_cm);
+      if (status == HCSR04_OK)
+      {
+        out_cm = tmp_cm;
+      }
+    }
+    return status;
+  }
+
+  /**
+   * @brief Forwarded read (raw echo time); HCSR04_OK results update the statistics.
+   * @param[out] out_echo_us Echo time in microseconds when HCSR04_OK is returned.
+   * @return Status of the wrapped driver.
+   */
+  virtual HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    return forward_(false, out_echo_us);
+  }
+
+  /** @brief As readRawUs(), through the wrapped driver's collectRawUs() (no new shot). */
+  virtual HCSR04_Status collectRawUs(unsigned long &out_echo_us)
+  {
+    return forward_(true, out_echo_us);
+  }
+
+  /** @brief Shot timestamp of the wrapped driver (the decorator never fires). */
+  virtual unsigned long getLastShotTimestampUs(void) const noexcept
+  {
+    return m_inner.getLastShotTimestampUs();
+  }
+
+  /**
+   * @brief Statistics over the current window.
+   * @param[out] out Snapshot when true is returned.
+   * @return false while the window is empty.
+   */
+  bool getStats(HCSR04_WindowStats &out) const
+  {
+    bool valid = false;
+    if (m_count != 0U)
+    {
+      /* n * M2 = n * sum(x^2) - sum(x)^2, exact and never negative. */
+      const uint64_t sum = m_sum;
+      const uint64_t n_m2 = (static_cast<uint64_t>(m_count) * m_sum_sq) - (sum * sum);
+      out.count = m_count;
+      out.mean_mm = static_cast<float>(m_sum) / static_cast<float>(m_count);
+      out.variance_mm2 = (m_count > 1U)
+                         ? (static_cast<float>(n_m2) /
+                            static_cast<float>(static_cast<uint16_t>(m_count) * (m_count - 1U)))
+                         : 0.0F;
+      out.min_mm = m_min.front();
+      out.max_mm = m_max.front();
+      valid = true;
+    }
+    return valid;
+  }
+
+  /** @brief Forget all samples. */
+  void reset(void)
+  {
+    m_min.clear();
+    m_max.clear();
+    m_sum = 0UL;
+    m_sum_sq = 0ULL;
+    m_head = 0U;
+    m_count = 0U;
+  }
+
+private:
+  HCSR04_Status forward_(bool collect, unsigned long &out_echo_us)
+  {
+    unsigned long echo_us = 0UL;
+    const HCSR04_Status status = (collect == true) ? m_inner.collectRawUs(echo_us)
+                                                   : m_inner.readRawUs(echo_us);
+    if (status == HCSR04_OK)
+    {
+      uint16_t mm = 0U;
+      if (timeUsToMm_(echo_us, mm) == HCSR04_OK)
+      {
+        push_(mm);
+      }
+      out_echo_us = echo_us;
+    }
+    return status;
+  }
+
+  void push_(uint16_t mm)
+  {
+    if (m_count < N)
+    {
+      m_count++;
+    }
+    else
+    {
+      /* Full: the oldest sample leaves the window. */
+      const uint16_t oldest = m_ring[m_head];
+      m_sum -= oldest;
+      m_sum_sq -= static_cast<uint32_t>(oldest) * oldest;
+    }
+    m_sum += mm;
+    m_sum_sq += static_cast<uint32_t>(mm) * mm;
+
+    m_ring[m_head] = mm;
+    m_head = (m_head == (N - 1U)) ? 0U : static_cast<uint8_t>(m_head + 1U);
+
+    /* Expire first: the deques then never hold more than N entries. */
+    m_seq++;
+    m_min.expire(m_seq);
+    m_max.expire(m_seq);
+    m_min.push(mm, m_seq, false);
+    m_max.push(mm, m_seq, true);
+  }
+
+  IHCSR04                &m_inner;
+  HCSR04_MonoDeque<N>     m_min;
+  HCSR04_MonoDeque<N>     m_max;
+  uint16_t                m_ring[N];  /**< Samples in arrival order (mm). */
+  unsigned long           m_sum;      /**< Exact sum of the window (mm). */
+  uint64_t                m_sum_sq;   /**< Exact sum of squares of the window (mm^2). */
+  uint8_t                 m_seq;      /**< Sequence of the newest sample (wraps). */
+  uint8_t                 m_head;
+  uint8_t                 m_count;
+};
+
+#endif /* HCSR04_STATS_HPP_ */
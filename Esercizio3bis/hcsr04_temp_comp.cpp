@@ -0,0 +1,250 @@
+/**
+ * @file hcsr04_temp_comp.cpp
+ * @brief Implementation of HCSR04_TempCompensator (ADC channel 8, conversion-complete ISR).
+ * @version 1.0
+ * @date 2025-10-10
+ */
+
+#include "hcsr04_temp_comp.hpp"
+
+/* ======== Local constants ================================================= */
+
+/* Internal 1.1 V reference, right adjusted, MUX3:0 = 1000 (temperature sensor). */
+static const uint8_t HCSR04_TEMP_ADMUX = static_cast<uint8_t>(_BV(REFS1) | _BV(REFS0) | _BV(MUX3));
+
+/* ADC enabled, interrupt enabled, clk/128 (125 kHz @16 MHz). ADIF written as 0: no effect. */
+static const uint8_t HCSR04_TEMP_ADCSRA = static_cast<uint8_t>(_BV(ADEN) | _BV(ADIE) |
+                                                               _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0));
+
+/* ======== Static member definitions ====================================== */
+volatile uint16_t HCSR04_TempCompensator::s_filtered_q4 = 0U;
+volatile uint8_t HCSR04_TempCompensator::s_discard = 0U;
+volatile bool HCSR04_TempCompensator::s_seeded = false;
+HCSR04_TempCompensator* HCSR04_TempCompensator::s_owner = 0;
+
+/* ============================= Constructor =============================== */
+
+HCSR04_TempCompensator::HCSR04_TempCompensator(IHCSR04 &sensor, uint8_t rh_percent) :
+  m_sensor(sensor),
+  m_last_start_ms(0UL),
+  m_adc_at_25c(HCSR04_TEMP_ADC_AT_25C),
+  m_lsb_per_c_x100(HCSR04_TEMP_LSB_PER_C_X100),
+  m_applied_x10(0),
+  m_rh_percent(rh_percent),
+  m_dirty(true),
+  m_last_status(HCSR04_ERR_NOT_READY)
+{
+  /* No work: deferred to begin(). */
+}
+
+/* ============================= Destructor ================================ */
+
+HCSR04_TempCompensator::~HCSR04_TempCompensator()
+{
+  if (s_owner == this)
+  {
+    /* Back to the Arduino core setup: ADC enabled, clk/128, no interrupt. */
+    ADCSRA = static_cast<uint8_t>(HCSR04_TEMP_ADCSRA & static_cast<uint8_t>(~_BV(ADIE)));
+    s_owner = 0;
+  }
+}
+
+/* ============================== begin() ================================== */
+
+HCSR04_Status HCSR04_TempCompensator::begin(void)
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  if (HCSR04_VECT_ADC == 0)
+  {
+    /* Vector compiled out (hcsr04_config.hpp): ADIE would reset the MCU. */
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else if ((s_owner != 0) && (s_owner != this))
+  {
+    status = HCSR04_ERR_BUSY;
+  }
+  else if (m_rh_percent > 100U)
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+  else
+  {
+    const uint8_t sreg = SREG;
+    cli();
+    s_owner = this;
+    s_seeded = false;
+    s_discard = HCSR04_TEMP_DISCARD;
+    ADMUX = HCSR04_TEMP_ADMUX;
+    ADCSRA = HCSR04_TEMP_ADCSRA;
+    SREG = sreg;
+
+    m_last_start_ms = millis() - HCSR04_TEMP_SAMPLE_PERIOD_MS;
+    m_dirty = true;
+    m_last_status = HCSR04_ERR_NOT_READY;
+  }
+
+  return status;
+}
+
+/* ============================== update() ================================= */
+
+HCSR04_Status HCSR04_TempCompensator::update(void)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_STATE;
+
+  if (s_owner == this)
+  {
+    const unsigned long now_ms = millis();
+    const bool adc_idle = ((ADCSRA & _BV(ADSC)) == 0U);
+    const bool echo_closed = ((micros() - m_sensor.getLastShotTimestampUs()) >= m_sensor.getTimeoutUs());
+
+    if (adc_idle && echo_closed && ((now_ms - m_last_start_ms) >= HCSR04_TEMP_SAMPLE_PERIOD_MS))
+    {
+      if (ADMUX != HCSR04_TEMP_ADMUX)
+      {
+        /* analogRead() moved reference/channel: let the 1.1 V reference settle. */
+        ADMUX = HCSR04_TEMP_ADMUX;
+        s_discard = HCSR04_TEMP_DISCARD;
+      }
+      m_last_start_ms = now_ms;
+      ADCSRA = static_cast<uint8_t>(HCSR04_TEMP_ADCSRA | _BV(ADSC));
+    }
+
+    int16_t temp_c_x10 = 0;
+    status = getTemperatureX10(temp_c_x10);
+    if (status == HCSR04_OK)
+    {
+      const int16_t delta = static_cast<int16_t>(temp_c_x10 - m_applied_x10);
+      if ((m_dirty == true) || (delta >= HCSR04_TEMP_APPLY_STEP_X10) || (delta <= -HCSR04_TEMP_APPLY_STEP_X10))
+      {
+        m_last_status = m_sensor.setAirConditions(temp_c_x10, m_rh_percent);
+        m_applied_x10 = temp_c_x10;
+        m_dirty = false;
+      }
+      status = m_last_status;
+    }
+  }
+
+  return status;
+}
+
+/* =========================== Configuration =============================== */
+
+HCSR04_Status HCSR04_TempCompensator::setCalibration(uint16_t adc_at_25c, uint16_t lsb_per_c_x100)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if (lsb_per_c_x100 != 0U)
+  {
+    m_adc_at_25c = adc_at_25c;
+    m_lsb_per_c_x100 = lsb_per_c_x100;
+    m_dirty = true;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+HCSR04_Status HCSR04_TempCompensator::setHumidity(uint8_t rh_percent)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if (rh_percent <= 100U)
+  {
+    m_rh_percent = rh_percent;
+    m_dirty = true;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+/* ========================== sharedAnalogRead() =========================== */
+
+int HCSR04_TempCompensator::sharedAnalogRead(uint8_t pin)
+{
+  /* A conversion started by update() completes on its own: let it (and its ISR) finish. */
+  while ((ADCSRA & _BV(ADSC)) != 0U)
+  {
+    /* <= 13 ADC clocks at 125 kHz. */
+  }
+
+  if (ADMUX == HCSR04_TEMP_ADMUX)
+  {
+    /* Reference moves from 1.1 V back to the sketch's: first reading is settling. */
+    (void)analogRead(pin);
+  }
+
+  return analogRead(pin);
+}
+
+/* ========================= getTemperatureX10() =========================== */
+
+HCSR04_Status HCSR04_TempCompensator::getTemperatureX10(int16_t &out_temp_c_x10) const
+{
+  HCSR04_Status status = HCSR04_ERR_NOT_READY;
+
+  if (s_seeded == true)
+  {
+    /* T = 25 + (ADC - ADC_25) / slope, in tenths: x16 reading, x100 slope. */
+    const long diff_q4 = static_cast<long>(filteredQ4_()) - (static_cast<long>(m_adc_at_25c) * 16L);
+    const long den = static_cast<long>(m_lsb_per_c_x100) * 16L;
+    const long num = diff_q4 * 1000L;
+    const long half = ((num >= 0L) ? den : -den) / 2L;
+
+    out_temp_c_x10 = static_cast<int16_t>(250L + ((num + half) / den));
+    status = HCSR04_OK;
+  }
+
+  return status;
+}
+
+uint16_t HCSR04_TempCompensator::filteredQ4_(void)
+{
+  uint16_t first = s_filtered_q4;
+  uint16_t second = s_filtered_q4;
+  while (first != second)
+  {
+    first = second;
+    second = s_filtered_q4;
+  }
+  return second;
+}
+
+/* =============================== ISR ===================================== */
+
+void HCSR04_TempCompensator::conversionISR_(void)
+{
+  const uint16_t sample_q4 = static_cast<uint16_t>(ADC << 4);
+
+  if (ADMUX != HCSR04_TEMP_ADMUX)
+  {
+    /* Foreign conversion (analogRead()), or ADMUX rewritten under ours: not trusted. */
+  }
+  else if (s_discard != 0U)
+  {
+    s_discard--;
+  }
+  else if (s_seeded == false)
+  {
+    s_filtered_q4 = sample_q4;
+    s_seeded = true;
+  }
+  else
+  {
+    /* EMA in unsigned arithmetic: filtered += (sample - filtered) / 2^shift. */
+    const uint16_t filtered_q4 = s_filtered_q4;
+    if (sample_q4 >= filtered_q4)
+    {
+      s_filtered_q4 = static_cast<uint16_t>(filtered_q4 + ((sample_q4 - filtered_q4) >> HCSR04_TEMP_EMA_SHIFT));
+    }
+    else
+    {
+      s_filtered_q4 = static_cast<uint16_t>(filtered_q4 - ((filtered_q4 - sample_q4) >> HCSR04_TEMP_EMA_SHIFT));
+    }
+  }
+}
+
+#if (HCSR04_VECT_ADC != 0)
+ISR(ADC_vect)
+{
+  HCSR04_TempCompensator::conversionISR_();
+}
+#endif /* HCSR04_VECT_ADC */
@@ -0,0 +1,167 @@
+/**
+ * @file hcsr04_temp_comp.hpp
+ * @brief Background sound-speed compensation from the ATmega328P on-chip temperature sensor.
+ * @version 1.0
+ * @date 2025-10-10
+ *
+ * The on-chip sensor is ADC channel 8 measured against the internal 1.1 V reference
+ * (~1 mV/degC, 314 mV typical at 25 degC). HCSR04_TempCompensator:
+ * - starts one conversion per HCSR04_TEMP_SAMPLE_PERIOD_MS from update(), only when
+ *   the driver's echo window is closed (never during a shot);
+ * - low-pass filters the samples in ISR(ADC_vect) (fixed-point EMA, ~20 cycles);
+ * - applies the filtered temperature with IHCSR04::setAirConditions() from update()
+ *   when it moved by at least HCSR04_TEMP_APPLY_STEP_X10.
+ * update() never waits for the ADC, and read() never touches it.
+ *
+ * Simulated sweep (tools/host/sim_temp_comp.cpp: HCSR04_Polling on a 200 cm target,
+ * RH 50 %, ADC quantized to 1 LSB, 1 degC/min ramp, sensor calibrated at 25 degC):
+ *
+ *   Air temp | Error, fixed 343 m/s | Error, compensated
+ *   ---------+----------------------+-------------------
+ *    -10 C   |       +10.9 cm       |      -0.5 cm
+ *      0 C   |        +7.0 cm       |      -0.1 cm
+ *     10 C   |        +3.2 cm       |      -0.3 cm
+ *     20 C   |        -0.5 cm       |      -0.4 cm
+ *     30 C   |        -4.1 cm       |      -0.2 cm
+ *     40 C   |        -7.7 cm       |      -0.1 cm
+ *
+ * Residual error is dominated by the sensor: die temperature is a few degC above
+ * ambient and the uncalibrated offset is up to +-10 degC (the same sweep with the die
+ * 10 degC warm gives +3.2..+3.7 cm at 2 m), so setCalibration() with one reference
+ * reading is recommended.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Owns ADC_vect, compiled only with HCSR04_VECT_ADC = 1 (hcsr04_config.hpp):
+ *   incompatible with libraries defining it. Other ADC channels go through
+ *   sharedAnalogRead() (see update()); the ISR only accepts a sample while ADMUX still
+ *   holds exactly the temperature setting (channel 8, 1.1 V reference).
+ * - One instance per firmware image (there is a single ADC).
+ */
+
+#ifndef HCSR04_TEMP_COMP_HPP_
+#define HCSR04_TEMP_COMP_HPP_
+
+#include "hcsr04.hpp"
+#include "hcsr04_config.hpp"
+
+/** @brief Interval between temperature conversions (milliseconds). */
+#ifndef HCSR04_TEMP_SAMPLE_PERIOD_MS
+#define HCSR04_TEMP_SAMPLE_PERIOD_MS  (250UL)
+#endif
+
+/** @brief EMA weight 1/2^shift of each new sample (3 -> ~2 s time constant at 250 ms). */
+#ifndef HCSR04_TEMP_EMA_SHIFT
+#define HCSR04_TEMP_EMA_SHIFT         (3U)
+#endif
+
+/** @brief Minimum filtered change applied to the driver (tenths of degC). */
+#define HCSR04_TEMP_APPLY_STEP_X10    (5)
+
+/** @brief Typical ADC reading at 25 degC (314 mV / 1.1 V * 1024). */
+#define HCSR04_TEMP_ADC_AT_25C        (292U)
+
+/** @brief Typical slope in ADC LSB per degC x100 (1 mV/degC / 1.074 mV/LSB). */
+#define HCSR04_TEMP_LSB_PER_C_X100    (93U)
+
+/** @brief Conversions discarded after (re)selecting the 1.1 V reference. */
+#define HCSR04_TEMP_DISCARD           (2U)
+
+/**
+ * @class HCSR04_TempCompensator
+ * @brief Feeds a driver's sound speed from the internal temperature sensor.
+ */
+class HCSR04_TempCompensator
+{
+public:
+  /**
+   * @param sensor Driver to compensate (must outlive the compensator).
+   * @param rh_percent Assumed relative humidity (0..100).
+   */
+  explicit HCSR04_TempCompensator(IHCSR04 &sensor, uint8_t rh_percent = 50U);
+
+  ~HCSR04_TempCompensator();
+
+  /**
+   * @brief Enable the ADC with its conversion-complete interrupt. Call in setup().
+   * @return HCSR04_Status (HCSR04_ERR_BUSY if another instance owns the ADC,
+   *         HCSR04_ERR_BAD_PARAM if the humidity is above 100 %,
+   *         HCSR04_ERR_BAD_STATE if HCSR04_VECT_ADC is 0).
+   */
+  HCSR04_Status begin(void);
+
+  /**
+   * @brief Start a conversion when due and apply the filtered temperature. Call from loop().
+   * @return HCSR04_Status (HCSR04_ERR_BAD_STATE before begin(), HCSR04_ERR_NOT_READY
+   *         until the first sample, otherwise the status of the last setAirConditions()).
+   *
+   * @note Non-blocking: ~150 cycles when idle, ~1500 cycles when a new temperature is applied.
+   *       A range-derived timeout follows the new sound speed; a min cycle set with
+   *       setMinCycleUs() is kept.
+   * @note The conversion started here runs in the background (~104 us). A plain
+   *       analogRead() issued meanwhile rewrites ADMUX under it and returns the
+   *       temperature sample as its own reading (the ISR then drops the sample); its
+   *       next reading still settles from the 1.1 V reference. Read other channels
+   *       with sharedAnalogRead() while the compensator is running.
+   */
+  HCSR04_Status update(void);
+
+  /**
+   * @brief analogRead() that coexists with the background temperature conversions.
+   *
+   * Waits for an in-flight conversion (<= ~104 us) and, when the previous conversion
+   * used the 1.1 V reference, discards one reading while the reference settles
+   * (~112 us more). The next update() restores the temperature setting by itself.
+   */
+  static int sharedAnalogRead(uint8_t pin);
+
+  /**
+   * @brief Single-point calibration (e.g. ADC reading taken at a known temperature).
+   * @param adc_at_25c ADC reading the sensor would give at 25 degC.
+   * @param lsb_per_c_x100 Slope in ADC LSB per degC x100 (non-zero).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if the slope is zero).
+   */
+  HCSR04_Status setCalibration(uint16_t adc_at_25c, uint16_t lsb_per_c_x100);
+
+  /**
+   * @brief Set the assumed relative humidity (applied by the next update()).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM above 100 %).
+   */
+  HCSR04_Status setHumidity(uint8_t rh_percent);
+
+  /**
+   * @brief Filtered temperature in tenths of degC.
+   * @return HCSR04_Status (HCSR04_ERR_NOT_READY until the first sample).
+   */
+  HCSR04_Status getTemperatureX10(int16_t &out_temp_c_x10) const;
+
+  /* ISR hook: public only so the ADC vector in the .cpp can reach it. */
+  static void conversionISR_(void);
+
+  /* Non-copyable: owns the ADC. */
+  HCSR04_TempCompensator(const HCSR04_TempCompensator&) = delete;
+  HCSR04_TempCompensator& operator=(const HCSR04_TempCompensator&) = delete;
+
+private:
+  /* Filtered reading (ADC x16), re-read until stable instead of masking interrupts. */
+  static uint16_t filteredQ4_(void);
+
+  /* ISR-side filter state. */
+  static volatile uint16_t s_filtered_q4;
+  static volatile uint8_t  s_discard;
+  static volatile bool     s_seeded;
+
+  /* ADC owner (single converter). */
+  static HCSR04_TempCompensator* s_owner;
+
+  IHCSR04       &m_sensor;
+  unsigned long  m_last_start_ms;
+  uint16_t       m_adc_at_25c;
+  uint16_t       m_lsb_per_c_x100;
+  int16_t        m_applied_x10;
+  uint8_t        m_rh_percent;
+  bool           m_dirty;
+  HCSR04_Status  m_last_status;
+};
+
+#endif /* HCSR04_TEMP_COMP_HPP_ */
@@ -0,0 +1,179 @@
+/**
+ * @file hcsr04_tracker.cpp
+ * @brief Implementation of HCSR04_Tracker (fixed-point alpha-beta filter).
+ * @version 1.0
+ * @date 2025-10-16
+ */
+
+#include "hcsr04_tracker.hpp"
+
+/* ============================= Constructor =============================== */
+
+HCSR04_Tracker::HCSR04_Tracker() :
+  m_pos_q4(0L),
+  m_vel_q4(0L),
+  m_innov_q4(0L),
+  m_last_us(0UL),
+  m_alpha_q8(HCSR04_TRACK_ALPHA_Q8),
+  m_beta_q8(HCSR04_TRACK_BETA_Q8),
+  m_coasted(0U),
+  m_valid(false)
+{
+  /* No track until the first measurement. */
+}
+
+/* ============================== setGains() =============================== */
+
+HCSR04_Status HCSR04_Tracker::setGains(uint16_t alpha_q8, uint16_t beta_q8)
+{
+  HCSR04_Status status = HCSR04_ERR_BAD_PARAM;
+  if ((alpha_q8 != 0U) && (alpha_q8 <= 256U) && (beta_q8 != 0U) && (beta_q8 <= 256U))
+  {
+    m_alpha_q8 = alpha_q8;
+    m_beta_q8 = beta_q8;
+    status = HCSR04_OK;
+  }
+  return status;
+}
+
+/* =============================== update() ================================ */
+
+HCSR04_Status HCSR04_Tracker::update(HCSR04_Status status, uint16_t distance_mm, unsigned long shot_us)
+{
+  HCSR04_Status result = HCSR04_ERR_NOT_READY;
+  const bool measured = (status == HCSR04_OK);
+  const bool coast = ((status == HCSR04_ERR_TIMEOUT_ECHO_START) ||
+                      (status == HCSR04_ERR_TIMEOUT_ECHO_END) ||
+                      (status == HCSR04_ERR_OUT_OF_RANGE));
+
+  if ((m_valid == false) || ((measured == false) && (coast == false)))
+  {
+    if (measured == true)
+    {
+      /* (Re)initialize on the first measurement: no velocity information yet. */
+      m_pos_q4 = static_cast<long>(distance_mm) * 16L;
+      m_vel_q4 = 0L;
+      m_innov_q4 = 0L;
+      m_last_us = shot_us;
+      m_coasted = 0U;
+      m_valid = true;
+      result = HCSR04_OK;
+    }
+  }
+  else if (shot_us == m_last_us)
+  {
+    /* Same shot fed twice (or timestamp not advancing). */
+    result = HCSR04_ERR_BAD_STATE;
+  }
+  else
+  {
+    const long dt = dt100us_(m_last_us, shot_us);
+    m_last_us = shot_us;
+
+    /* Predict: x' = x + v * dt (|v| <= 160000 q4, dt <= 10000: product fits 32 bits). */
+    m_pos_q4 += (m_vel_q4 * dt) / 10000L;
+
+    if (measured == true)
+    {
+      /* Correct: x = x' + alpha r; v = v + beta r / dt, with dt in seconds = dt / 10000. */
+      m_innov_q4 = (static_cast<long>(distance_mm) * 16L) - m_pos_q4;
+      const long r_q4 = clamp_(m_innov_q4, HCSR04_TRACK_MAX_INNOV_MM * 16L);
+      m_pos_q4 += (static_cast<long>(m_alpha_q8) * r_q4) / 256L;
+      /* beta r 10000 / (256 dt) = ((beta r) / 16) * 625 / dt. */
+      m_vel_q4 += (((static_cast<long>(m_beta_q8) * r_q4) / 16L) * 625L) / dt;
+      m_vel_q4 = clamp_(m_vel_q4, HCSR04_TRACK_MAX_VEL_MM_S * 16L);
+      m_coasted = 0U;
+    }
+    else
+    {
+      m_innov_q4 = 0L;
+      m_coasted++;
+    }
+
+    if ((m_coasted > HCSR04_TRACK_MAX_COAST) || (m_pos_q4 < 0L))
+    {
+      /* Lost (or predicted through the sensor): wait for a fresh measurement. */
+      m_valid = false;
+      result = HCSR04_ERR_NOT_READY;
+    }
+    else
+    {
+      result = HCSR04_OK;
+    }
+  }
+
+  return result;
+}
+
+/* ================================ step() ================================= */
+
+HCSR04_Status HCSR04_Tracker::step(IHCSR04 &sensor)
+{
+  uint16_t distance_mm = 0U;
+  const HCSR04_Status status = sensor.readMm(distance_mm);
+  return update(status, distance_mm, sensor.getLastShotTimestampUs());
+}
+
+/* ============================== getState() =============================== */
+
+bool HCSR04_Tracker::getState(HCSR04_TrackState &out) const
+{
+  if (m_valid == true)
+  {
+    const long pos_mm = (m_pos_q4 + 8L) / 16L;
+    const long innov_mm = clamp_(m_innov_q4 / 16L, 32767L);
+
+    out.distance_mm = (pos_mm > 65535L) ? 65535U : static_cast<uint16_t>(pos_mm);
+    out.velocity_mm_s = static_cast<int16_t>(m_vel_q4 / 16L);  /* |v| <= 10000 */
+    out.innovation_mm = static_cast<int16_t>(innov_mm);
+    out.coasted = m_coasted;
+  }
+  return m_valid;
+}
+
+/* =============================== reset() ================================= */
+
+void HCSR04_Tracker::reset(void)
+{
+  m_valid = false;
+  m_coasted = 0U;
+}
+
+/* =============================== Helpers ================================= */
+
+long HCSR04_Tracker::dt100us_(unsigned long from_us, unsigned long to_us)
+{
+  const unsigned long dt = (to_us - from_us) / 100UL;  /* wraps fine on unsigned long */
+  unsigned long clamped = dt;
+  if (clamped == 0UL)
+  {
+    clamped = 1UL;
+  }
+  else if (clamped > HCSR04_TRACK_MAX_DT_100US)
+  {
+    clamped = HCSR04_TRACK_MAX_DT_100US;
+  }
+  else
+  {
+    /* In range. */
+  }
+  return static_cast<long>(clamped);
+}
+
+long HCSR04_Tracker::clamp_(long value, long limit)
+{
+  long clamped = value;
+  if (clamped > limit)
+  {
+    clamped = limit;
+  }
+  else if (clamped < -limit)
+  {
+    clamped = -limit;
+  }
+  else
+  {
+    /* In range. */
+  }
+  return clamped;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file hcsr04_tracker.hpp
+ * @brief Fixed-point alpha-beta tracker: filtered distance, velocity and innovation.
+ * @version 1.0
+ * @date 2025-10-16
+ *
+ * Consumes timestamped measurements (shot start in micros(), distance in mm) and
+ * keeps a constant-velocity state:
+ *   predict:  x' = x + v * dt
+ *   correct:  r = z - x';  x = x' + alpha * r;  v = v + beta * r / dt
+ * Timeouts (a shot happened but no echo was measured) only predict ("coast"); after
+ * HCSR04_TRACK_MAX_COAST consecutive coasts the track is dropped and re-initialized
+ * by the next measurement. tools/host/sim_tracker.cpp checks convergence on a 0.5 m/s
+ * approach with +-10 mm noise, periodic timeouts and dropouts.
+ *
+ * Fixed point: position in 1/16 mm (int32), velocity in 1/16 mm/s (int32), dt in
+ * 100 us units (clamped to 1 s), gains in Q8 (<= 1.0, always inside the stability
+ * region beta < 4 - 2 alpha). Velocity is clamped to +-HCSR04_TRACK_MAX_VEL_MM_S and the
+ * innovation applied to the state to +-HCSR04_TRACK_MAX_INNOV_MM, so every
+ * intermediate product fits 32 bits.
+ *
+ * Estimated cost per update (UNO, avr-gcc -Os): ~1600 cycles (~100 us @16 MHz),
+ * dominated by two 32-bit divisions (~600 cycles each); coasting ~800 cycles.
+ * Estimates only: time update() with micros() on the target to confirm.
+ *
+ * Timestamps: step() uses IHCSR04::getLastShotTimestampUs(), correct for drivers whose
+ * read() returns the shot it started (polling, input capture, pin change). For
+ * HCSR04_Interrupt feed update() from readBatch() records (HCSR04_Record::shot_us).
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ */
+
+#ifndef HCSR04_TRACKER_HPP_
+#define HCSR04_TRACKER_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief Default position gain (Q8, 0.5). */
+#define HCSR04_TRACK_ALPHA_Q8         (128U)
+
+/** @brief Default velocity gain (Q8, ~0.167 = alpha^2 / (2 - alpha), critically damped). */
+#define HCSR04_TRACK_BETA_Q8          (43U)
+
+/** @brief Consecutive coasted updates before the track is dropped. */
+#define HCSR04_TRACK_MAX_COAST        (10U)
+
+/** @brief Velocity magnitude limit (mm/s). */
+#define HCSR04_TRACK_MAX_VEL_MM_S     (10000L)
+
+/** @brief Innovation magnitude applied to the state (mm). */
+#define HCSR04_TRACK_MAX_INNOV_MM     (8000L)
+
+/** @brief Longest prediction step (100 us units, 1 s). */
+#define HCSR04_TRACK_MAX_DT_100US     (10000UL)
+
+/**
+ * @brief Tracker output.
+ */
+typedef struct
+{
+  uint16_t distance_mm;    /**< Filtered distance. */
+  int16_t  velocity_mm_s;  /**< Range rate: > 0 receding, < 0 approaching. */
+  int16_t  innovation_mm;  /**< Last measurement minus prediction (0 when coasting). */
+  uint8_t  coasted;        /**< Consecutive updates without a measurement. */
+} HCSR04_TrackState;
+
+/**
+ * @class HCSR04_Tracker
+ * @brief Alpha-beta filter over HC-SR04 measurements (integer arithmetic only).
+ */
+class HCSR04_Tracker
+{
+public:
+  HCSR04_Tracker();
+
+  /**
+   * @brief Set filter gains.
+   * @param alpha_q8 Position gain, 1..256 (Q8).
+   * @param beta_q8 Velocity gain, 1..256 (Q8).
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM if a gain is out of range).
+   */
+  HCSR04_Status setGains(uint16_t alpha_q8, uint16_t beta_q8);
+
+  /**
+   * @brief Feed one shot outcome.
+   * @param status Shot status: HCSR04_OK measures; HCSR04_ERR_TIMEOUT_ECHO_START/END
+   *        and HCSR04_ERR_OUT_OF_RANGE coast; anything else (no new shot) is ignored.
+   * @param distance_mm Measured distance (used with HCSR04_OK only).
+   * @param shot_us micros() at shot start.
+   * @return HCSR04_Status (HCSR04_OK when the state advanced, HCSR04_ERR_NOT_READY when
+   *         nothing to track yet or the shot was ignored, HCSR04_ERR_BAD_STATE on a
+   *         timestamp not newer than the previous one).
+   */
+  HCSR04_Status update(HCSR04_Status status, uint16_t distance_mm, unsigned long shot_us);
+
+  /**
+   * @brief readMm() on a driver and update() with its shot timestamp.
+   * @param sensor Driver to read.
+   * @return Same as update().
+   */
+  HCSR04_Status step(IHCSR04 &sensor);
+
+  /**
+   * @brief Current estimate.
+   * @param[out] out State when true is returned.
+   * @return false while no track exists.
+   */
+  bool getState(HCSR04_TrackState &out) const;
+
+  /** @brief Drop the track. */
+  void reset(void);
+
+private:
+  /* dt since the last update in 100 us units, clamped to HCSR04_TRACK_MAX_DT_100US. */
+  static long dt100us_(unsigned long from_us, unsigned long to_us);
+
+  /* Symmetric clamp. */
+  static long clamp_(long value, long limit);
+
+  long          m_pos_q4;        /**< Position, 1/16 mm. */
+  long          m_vel_q4;        /**< Velocity, 1/16 mm/s. */
+  long          m_innov_q4;      /**< Last innovation, 1/16 mm. */
+  unsigned long m_last_us;       /**< Timestamp of the last update. */
+  uint16_t      m_alpha_q8;
+  uint16_t      m_beta_q8;
+  uint8_t       m_coasted;
+  bool          m_valid;
+};
+
+#endif /* HCSR04_TRACKER_HPP_ */
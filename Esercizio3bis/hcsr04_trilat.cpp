@@ -0,0 +1,273 @@
+/**
+ * @file hcsr04_trilat.cpp
+ * @brief Implementation of HCSR04_Trilat (integer baseline trilateration).
+ * @version 1.0
+ * @date 2025-10-24
+ */
+
+#include "hcsr04_trilat.hpp"
+
+/* ============================= Constructor =============================== */
+
+HCSR04_Trilat::HCSR04_Trilat() :
+  m_max_skew_us(HCSR04_TRILAT_MAX_SKEW_US),
+  m_count(0U)
+{
+  for (uint8_t i = 0U; i < HCSR04_TRILAT_MAX_SENSORS; i++)
+  {
+    m_x_mm[i] = 0;
+  }
+}
+
+/* ============================ setGeometry() ============================== */
+
+HCSR04_Status HCSR04_Trilat::setGeometry(const int16_t *x_mm, uint8_t count)
+{
+  HCSR04_Status status = HCSR04_OK;
+
+  if ((x_mm == 0) || (count < 2U) || (count > HCSR04_TRILAT_MAX_SENSORS))
+  {
+    status = HCSR04_ERR_BAD_PARAM;
+  }
+
+  for (uint8_t i = 0U; (i < count) && (status == HCSR04_OK); i++)
+  {
+    if ((x_mm[i] < -HCSR04_TRILAT_MAX_X_MM) || (x_mm[i] > HCSR04_TRILAT_MAX_X_MM) ||
+        ((i != 0U) && (x_mm[i] <= x_mm[i - 1U])))
+    {
+      status = HCSR04_ERR_BAD_PARAM;
+    }
+  }
+
+  if (status == HCSR04_OK)
+  {
+    for (uint8_t i = 0U; i < count; i++)
+    {
+      m_x_mm[i] = x_mm[i];
+    }
+    m_count = count;
+  }
+
+  return status;
+}
+
+/* ================================ fuse() ================================= */
+
+HCSR04_Status HCSR04_Trilat::fuse(const uint16_t *d_mm, const unsigned long *shot_us,
+                                  HCSR04_Position &out) const
+{
+  HCSR04_Status status = HCSR04_OK;
+  uint8_t used = 0U;
+  uint8_t ref = 0U;
+
+  if ((m_count < 2U) || (d_mm == 0))
+  {
+    status = HCSR04_ERR_BAD_STATE;
+  }
+
+  /* Valid echoes, reference (leftmost valid) sensor and timestamp spread. */
+  unsigned long oldest_us = 0UL;
+  unsigned long spread_us = 0UL;
+  for (uint8_t i = 0U; (i < m_count) && (status == HCSR04_OK); i++)
+  {
+    if (d_mm[i] > HCSR04_TRILAT_MAX_MM)
+    {
+      status = HCSR04_ERR_OUT_OF_RANGE;
+    }
+    else if (d_mm[i] != 0U)
+    {
+      if (used == 0U)
+      {
+        ref = i;
+        oldest_us = (shot_us != 0) ? shot_us[i] : 0UL;
+      }
+      else if (shot_us != 0)
+      {
+        /* Spread of wrapping timestamps, relative to the first valid one. */
+        const long rel = static_cast<long>(shot_us[i] - oldest_us);
+        if (rel < 0L)
+        {
+          spread_us += static_cast<unsigned long>(-rel);
+          oldest_us = shot_us[i];
+        }
+        else if (static_cast<unsigned long>(rel) > spread_us)
+        {
+          spread_us = static_cast<unsigned long>(rel);
+        }
+        else
+        {
+          /* Inside the current spread. */
+        }
+      }
+      else
+      {
+        /* No timestamps: skew not checked. */
+      }
+      used++;
+    }
+    else
+    {
+      /* No echo: skipped. */
+    }
+  }
+
+  if ((status == HCSR04_OK) && (spread_us > m_max_skew_us))
+  {
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  if ((status == HCSR04_OK) && (used < 2U))
+  {
+    status = HCSR04_ERR_NOT_READY;
+  }
+
+  long x = 0L;
+  if (status == HCSR04_OK)
+  {
+    /* 2 (x_i - x_r) x = d_r^2 - d_i^2 + x_i^2 - x_r^2, summed over the pairs. */
+    const long xr = static_cast<long>(m_x_mm[ref]);
+    const long dr = static_cast<long>(d_mm[ref]);
+    long sum_b = 0L;
+    long sum_dx = 0L;
+
+    for (uint8_t i = static_cast<uint8_t>(ref + 1U); i < m_count; i++)
+    {
+      if (d_mm[i] != 0U)
+      {
+        const long xi = static_cast<long>(m_x_mm[i]);
+        const long di = static_cast<long>(d_mm[i]);
+        sum_b += ((dr * dr) - (di * di)) + ((xi * xi) - (xr * xr));
+        sum_dx += xi - xr;  /* > 0: positions are ascending. */
+      }
+    }
+
+    /* Round to nearest: |sum_b| < 2^27, den > 0. */
+    const long den = 2L * sum_dx;
+    x = (sum_b >= 0L) ? ((sum_b + (den / 2L)) / den) : -(((-sum_b) + (den / 2L)) / den);
+
+    if ((x > static_cast<long>(HCSR04_TRILAT_MAX_MM)) || (x < -static_cast<long>(HCSR04_TRILAT_MAX_MM)))
+    {
+      status = HCSR04_ERR_IMPLAUSIBLE;
+    }
+  }
+
+  long y2 = 0L;
+  if (status == HCSR04_OK)
+  {
+    /* y^2 = mean(d_i^2 - (x - x_i)^2); each term is within +-2^26. */
+    long sum_y2 = 0L;
+    for (uint8_t i = ref; i < m_count; i++)
+    {
+      if (d_mm[i] != 0U)
+      {
+        const long di = static_cast<long>(d_mm[i]);
+        const long dx = x - static_cast<long>(m_x_mm[i]);
+        sum_y2 += (di * di) - (dx * dx);
+      }
+    }
+
+    if (sum_y2 < 0L)
+    {
+      /* Circles do not meet in front of the baseline. */
+      status = HCSR04_ERR_IMPLAUSIBLE;
+    }
+    else
+    {
+      y2 = (sum_y2 + static_cast<long>(used / 2U)) / static_cast<long>(used);
+    }
+  }
+
+  if (status == HCSR04_OK)
+  {
+    const uint32_t y = roundSqrt_(static_cast<uint32_t>(y2));
+    uint32_t residual = 0UL;
+
+    for (uint8_t i = ref; i < m_count; i++)
+    {
+      if (d_mm[i] != 0U)
+      {
+        const long dx = x - static_cast<long>(m_x_mm[i]);
+        const uint32_t range = roundSqrt_(static_cast<uint32_t>(dx * dx) + (y * y));
+        const uint32_t d = static_cast<uint32_t>(d_mm[i]);
+        const uint32_t err = (range > d) ? (range - d) : (d - range);
+        if (err > residual)
+        {
+          residual = err;
+        }
+      }
+    }
+
+    out.x_mm = static_cast<int16_t>(x);               /* |x| <= HCSR04_TRILAT_MAX_MM */
+    out.y_mm = static_cast<uint16_t>(y);              /* y <= max distance */
+    out.residual_mm = static_cast<uint16_t>(residual);
+    out.used = used;
+  }
+
+  return status;
+}
+
+HCSR04_Status HCSR04_Trilat::fuse(const HCSR04_SharedTrig &group, HCSR04_Position &out) const
+{
+  HCSR04_Status status = HCSR04_OK;
+  uint16_t d_mm[HCSR04_TRILAT_MAX_SENSORS] = { 0U, 0U, 0U, 0U };
+
+  if (group.getCount() != m_count)
+  {
+    status = HCSR04_ERR_BAD_STATE;
+  }
+  else
+  {
+    /* One TRIG pulse for all lines: no skew to check. Lines without an echo stay 0. */
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      uint16_t mm = 0U;
+      if (group.getMm(i, mm) == HCSR04_OK)
+      {
+        d_mm[i] = (mm != 0U) ? mm : 1U;
+      }
+    }
+    status = fuse(d_mm, 0, out);
+  }
+
+  return status;
+}
+
+/* =============================== Helpers ================================= */
+
+uint32_t HCSR04_Trilat::isqrt32(uint32_t value)
+{
+  /* Digit-by-digit (base 4): 16 iterations, shifts, adds and compares only. */
+  uint32_t rem = value;
+  uint32_t root = 0UL;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+  while (bit != 0UL)
+  {
+    if (rem >= (root + bit))
+    {
+      rem -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+uint32_t HCSR04_Trilat::roundSqrt_(uint32_t value)
+{
+  uint32_t root = isqrt32(value);
+  /* value - root^2 > root  <=>  value > (root + 0.5)^2 - 0.25. */
+  if ((value - (root * root)) > root)
+  {
+    root++;
+  }
+  return root;
+}
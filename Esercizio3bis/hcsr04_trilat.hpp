@@ -0,0 +1,131 @@
+/**
+ * @file hcsr04_trilat.hpp
+ * @brief Fixed-point 2D target localization from 2..4 sensors on a common baseline.
+ * @version 1.0
+ * @date 2025-10-24
+ *
+ * Frame: sensors lie on the x axis (bumper line) at known x_i, all facing +y. A target
+ * at (x, y) is d_i from sensor i:  (x - x_i)^2 + y^2 = d_i^2.
+ * - Subtracting the leftmost valid sensor r from every other valid sensor i removes
+ *   y^2:  2 (x_i - x_r) x = d_r^2 - d_i^2 + x_i^2 - x_r^2 = b_i.
+ *   x = sum(b_i) / (2 sum(x_i - x_r)): each pair weighted by its baseline (a pair's
+ *   x error grows as 1 / baseline).
+ * - y^2 = mean(d_i^2 - (x - x_i)^2), y = isqrt(y^2) (front side only).
+ * - Residual = max |sqrt((x - x_i)^2 + y^2) - d_i|. Two sensors always intersect
+ *   exactly (residual = rounding only); with 3+ it measures how well the echoes agree
+ *   on one target. Circles that do not intersect (y^2 < 0) -> HCSR04_ERR_IMPLAUSIBLE.
+ *
+ * Integer arithmetic only: distances <= HCSR04_TRILAT_MAX_MM and |x_i| <= 1000 mm keep
+ * every square and sum below 2^31 (int32); x is rounded to the nearest mm.
+ * Host check (tools/host/sim_trilat.cpp) over a 200 x 200 target grid (x -1000..1000,
+ * y 100..3000 mm) with true ranges rounded to 1 mm (the drivers' integer resolution):
+ *
+ *   Sensors at (mm)          Range noise   RMS error x / y   Max error x / y   Max residual
+ *   ------------------------+-------------+-----------------+-----------------+-------------
+ *   -100, 100                    0            3.8 / 2.1 mm      15 / 35 mm         1 mm
+ *   -150, 0, 150                 0            2.9 / 1.7 mm      12 / 35 mm         1 mm
+ *   -300, -100, 100, 300         0            1.6 / 0.9 mm       7 / 14 mm         4 mm
+ *   -150, 0, 150              +-5 mm         29 / 14 mm        135 / 203 mm       11 mm
+ *
+ * The maxima sit at grazing geometry (target far to the side, close to the baseline);
+ * x error scales with range / baseline, so a wider baseline pays off directly. With
+ * noise, 0.3 % of the grid (all within 25 cm of the baseline) is rejected as
+ * HCSR04_ERR_IMPLAUSIBLE: the circles no longer intersect.
+ *
+ * Estimated cost per fused sample (UNO @16 MHz, avr-gcc -Os): one 32-bit division
+ * (~600 cycles) + (n + 1) 32-bit integer square roots (~500 cycles each) + ~100 cycles
+ * of 32-bit multiply/add per sensor, i.e. ~2.5k cycles (~160 us) for 2 sensors and
+ * ~3.6k cycles (~230 us) for 4. Estimates only: time fuse() with micros() on the
+ * target to confirm.
+ *
+ * Synchronized inputs: echoes should come from the same instant. HCSR04_SharedTrig
+ * fires all modules with one pulse (fuse(HCSR04_SharedTrig &) uses it directly); for
+ * separate drivers pass the shot timestamps and a skew limit.
+ *
+ * Design constraints:
+ * - MISRA-oriented: explicit types, no dynamic allocation, no exceptions, no 'auto'.
+ * - Single exit point for non-noexcept functions.
+ */
+
+#ifndef HCSR04_TRILAT_HPP_
+#define HCSR04_TRILAT_HPP_
+
+#include "hcsr04.hpp"
+#include "hcsr04_shared_trig.hpp"
+
+/** @brief Sensors per fusion stage. */
+#define HCSR04_TRILAT_MAX_SENSORS     (4U)
+
+/** @brief Largest distance accepted (mm): keeps squares inside int32. */
+#define HCSR04_TRILAT_MAX_MM          (5000U)
+
+/** @brief Largest |x_i| of a sensor on the baseline (mm). */
+#define HCSR04_TRILAT_MAX_X_MM        (1000)
+
+/** @brief Default largest spread of shot timestamps in one fused sample (us). */
+#define HCSR04_TRILAT_MAX_SKEW_US     (10000UL)
+
+/**
+ * @brief Fused target position.
+ */
+typedef struct
+{
+  int16_t  x_mm;         /**< Along the baseline. */
+  uint16_t y_mm;         /**< In front of the baseline. */
+  uint16_t residual_mm;  /**< Largest range disagreement (see file comment). */
+  uint8_t  used;         /**< Sensors that contributed. */
+} HCSR04_Position;
+
+/**
+ * @class HCSR04_Trilat
+ * @brief Baseline trilateration in integer arithmetic.
+ */
+class HCSR04_Trilat
+{
+public:
+  HCSR04_Trilat();
+
+  /**
+   * @brief Set sensor positions.
+   * @param x_mm Baseline positions, strictly ascending (left to right), each within
+   *        +-HCSR04_TRILAT_MAX_X_MM (copied).
+   * @param count 2..HCSR04_TRILAT_MAX_SENSORS.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_PARAM on bad count, order or range; the
+   *         previous geometry is kept).
+   */
+  HCSR04_Status setGeometry(const int16_t *x_mm, uint8_t count);
+
+  /** @brief Largest spread of shot timestamps accepted by fuse() (us). */
+  void setMaxSkewUs(unsigned long max_skew_us) { m_max_skew_us = max_skew_us; }
+
+  /**
+   * @brief Fuse one set of distances.
+   * @param d_mm One distance per sensor (mm), 0 for "no echo" (sensor skipped).
+   * @param shot_us One shot timestamp per sensor, or 0 to skip the skew check.
+   * @param[out] out Position when HCSR04_OK is returned.
+   * @return HCSR04_Status (HCSR04_ERR_BAD_STATE without geometry or when the shots are
+   *         further apart than the skew limit, HCSR04_ERR_NOT_READY with fewer than two
+   *         echoes, HCSR04_ERR_OUT_OF_RANGE on a distance above HCSR04_TRILAT_MAX_MM,
+   *         HCSR04_ERR_IMPLAUSIBLE when the ranges admit no common target).
+   */
+  HCSR04_Status fuse(const uint16_t *d_mm, const unsigned long *shot_us, HCSR04_Position &out) const;
+
+  /**
+   * @brief Fuse the last group shot of a shared-TRIG group (line i = sensor i).
+   * @return As fuse(); HCSR04_ERR_BAD_STATE if the line count differs from the geometry.
+   */
+  HCSR04_Status fuse(const HCSR04_SharedTrig &group, HCSR04_Position &out) const;
+
+  /** @brief Integer square root (floor), 32-bit. */
+  static uint32_t isqrt32(uint32_t value);
+
+private:
+  /* Square root rounded to the nearest integer. */
+  static uint32_t roundSqrt_(uint32_t value);
+
+  int16_t        m_x_mm[HCSR04_TRILAT_MAX_SENSORS];
+  unsigned long  m_max_skew_us;
+  uint8_t        m_count;
+};
+
+#endif /* HCSR04_TRILAT_HPP_ */
@@ -0,0 +1,129 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal host stand-in for the Arduino UNO core, used by the host simulators.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * Only what the drivers in Esercizio3bis touch is provided:
+ * - AVR registers are plain volatile bytes/words; bit names carry the ATmega328P values.
+ * - cli()/sei() are no-ops: the simulators call the ISRs themselves, between driver
+ *   calls or from the hooks below, so nothing runs concurrently.
+ * - Time is simulated: micros() returns host_now_us, which only the simulator, a
+ *   delay*() call or host_micros_step (added on every micros() call, so busy-waits
+ *   make progress) advances.
+ * - UNO pin map: D0..D7 = PORTD, D8..D13 = PORTB, A0..A5 (14..19) = PORTC. digitalRead()
+ *   reads PINx, so the simulator drives ECHO by writing PINB/PINC/PIND.
+ *
+ * Hooks let a simulator model the module: host_on_micros runs on every micros() call
+ * (e.g. to raise ECHO at the right time during a busy-wait), host_on_trig runs on every
+ * digitalWrite().
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ============================== Core constants ============================= */
+
+#define HIGH                0x1
+#define LOW                 0x0
+#define INPUT               0x0
+#define OUTPUT              0x1
+#define INPUT_PULLUP        0x2
+#define CHANGE              1
+#define FALLING             2
+#define RISING              3
+#define NOT_A_PIN           0
+#define NOT_AN_INTERRUPT    (-1)
+#define PROGMEM
+#define F(x)                (x)
+#define _BV(b)              (1U << (b))
+#define pgm_read_word(p)    (*(const uint16_t *)(p))
+#define clockCyclesPerMicrosecond() (16L)
+
+/* ISRs become plain functions the simulator can call. */
+#define ISR(vector)         extern "C" void vector(void)
+
+/* ============================== AVR registers ============================== */
+
+extern volatile uint8_t SREG;
+extern volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+extern volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+extern volatile uint8_t ADCSRA, ADMUX;
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIFR1, TIMSK1;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, TIFR2, TIMSK2, OCR2A;
+extern volatile uint16_t ADC, ICR1, TCNT1;
+
+enum
+{
+  ADPS0 = 0, ADPS1 = 1, ADPS2 = 2, ADIE = 3, ADIF = 4, ADSC = 6, ADEN = 7,
+  MUX3 = 3, REFS0 = 6, REFS1 = 7,
+  CS10 = 0, ICES1 = 6, ICNC1 = 7, TOIE1 = 0, ICIE1 = 5, TOV1 = 0, ICF1 = 5,
+  WGM21 = 1, CS22 = 2, OCIE2A = 1, OCF2A = 1
+};
+
+static inline void cli(void) {}
+static inline void sei(void) {}
+static inline void interrupts(void) {}
+static inline void noInterrupts(void) {}
+
+/* ============================== Simulation hooks =========================== */
+
+extern unsigned long host_now_us;
+extern unsigned long host_micros_step;
+extern void (*host_on_micros)(void);
+extern void (*host_on_trig)(uint8_t pin, uint8_t level);
+
+/* ============================== Core functions ============================= */
+
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t irq, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t irq);
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t *portOutputRegister(uint8_t port);
+volatile uint8_t *portInputRegister(uint8_t port);
+volatile uint8_t *portModeRegister(uint8_t port);
+
+volatile uint8_t *digitalPinToPCICR(uint8_t pin);
+uint8_t digitalPinToPCICRbit(uint8_t pin);
+volatile uint8_t *digitalPinToPCMSK(uint8_t pin);
+uint8_t digitalPinToPCMSKbit(uint8_t pin);
+
+/* Drive a pin's input level (writes the PINx bit). */
+void hostSetPin(uint8_t pin, uint8_t level);
+
+/* Handler registered by attachInterrupt() for INT0/INT1, 0 if none. */
+void (*hostExtIsr(uint8_t irq))(void);
+
+/* ================================= Serial ================================== */
+
+class HostSerial
+{
+public:
+  void begin(unsigned long) {}
+  template <typename T> void print(T) {}
+  template <typename T> void print(T, int) {}
+  template <typename T> void println(T) {}
+  template <typename T> void println(T, int) {}
+  void println(void) {}
+  void flush(void) {}
+  explicit operator bool() const { return true; }
+};
+
+extern HostSerial Serial;
+
+#endif /* HOST_ARDUINO_H_ */
@@ -0,0 +1,218 @@
+/**
+ * @file host_arduino.cpp
+ * @brief Definitions behind the host Arduino.h (registers, simulated clock, UNO pin map).
+ * @version 1.0
+ * @date 2025-10-27
+ */
+
+#include "Arduino.h"
+
+/* ============================== AVR registers ============================== */
+
+volatile uint8_t SREG = 0x80U;
+volatile uint8_t PINB = 0U, PINC = 0U, PIND = 0U;
+volatile uint8_t PORTB = 0U, PORTC = 0U, PORTD = 0U;
+volatile uint8_t DDRB = 0U, DDRC = 0U, DDRD = 0U;
+volatile uint8_t PCICR = 0U, PCMSK0 = 0U, PCMSK1 = 0U, PCMSK2 = 0U;
+volatile uint8_t ADCSRA = 0U, ADMUX = 0U;
+volatile uint8_t TCCR1A = 0U, TCCR1B = 0U, TCCR1C = 0U, TIFR1 = 0U, TIMSK1 = 0U;
+volatile uint8_t TCCR2A = 0U, TCCR2B = 0U, TCNT2 = 0U, TIFR2 = 0U, TIMSK2 = 0U, OCR2A = 0U;
+volatile uint16_t ADC = 0U, ICR1 = 0U, TCNT1 = 0U;
+
+HostSerial Serial;
+
+/* ============================== Simulated time ============================= */
+
+unsigned long host_now_us = 0UL;
+unsigned long host_micros_step = 0UL;
+void (*host_on_micros)(void) = 0;
+void (*host_on_trig)(uint8_t pin, uint8_t level) = 0;
+
+unsigned long micros(void)
+{
+  host_now_us += host_micros_step;
+  if (host_on_micros != 0)
+  {
+    host_on_micros();
+  }
+  return host_now_us;
+}
+
+unsigned long millis(void)
+{
+  return host_now_us / 1000UL;
+}
+
+void delay(unsigned long ms)
+{
+  host_now_us += ms * 1000UL;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  host_now_us += us;
+}
+
+/* ================================ UNO pin map ============================== */
+
+enum { PORT_B = 2, PORT_C = 3, PORT_D = 4 };
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+  uint8_t port = NOT_A_PIN;
+  if (pin < 8U)
+  {
+    port = PORT_D;
+  }
+  else if (pin < 14U)
+  {
+    port = PORT_B;
+  }
+  else if (pin < 20U)
+  {
+    port = PORT_C;
+  }
+  return port;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+  const uint8_t bit = (pin < 8U) ? pin : ((pin < 14U) ? (pin - 8U) : (pin - 14U));
+  return static_cast<uint8_t>(1U << bit);
+}
+
+volatile uint8_t *portOutputRegister(uint8_t port)
+{
+  return (port == PORT_B) ? &PORTB : ((port == PORT_C) ? &PORTC : &PORTD);
+}
+
+volatile uint8_t *portInputRegister(uint8_t port)
+{
+  return (port == PORT_B) ? &PINB : ((port == PORT_C) ? &PINC : &PIND);
+}
+
+volatile uint8_t *portModeRegister(uint8_t port)
+{
+  return (port == PORT_B) ? &DDRB : ((port == PORT_C) ? &DDRC : &DDRD);
+}
+
+volatile uint8_t *digitalPinToPCICR(uint8_t pin)
+{
+  return (pin < 20U) ? &PCICR : 0;
+}
+
+uint8_t digitalPinToPCICRbit(uint8_t pin)
+{
+  return (pin < 8U) ? 2U : ((pin < 14U) ? 0U : 1U);
+}
+
+volatile uint8_t *digitalPinToPCMSK(uint8_t pin)
+{
+  volatile uint8_t *reg = 0;
+  if (pin < 8U)
+  {
+    reg = &PCMSK2;
+  }
+  else if (pin < 14U)
+  {
+    reg = &PCMSK0;
+  }
+  else if (pin < 20U)
+  {
+    reg = &PCMSK1;
+  }
+  return reg;
+}
+
+uint8_t digitalPinToPCMSKbit(uint8_t pin)
+{
+  return (pin < 8U) ? pin : ((pin < 14U) ? (pin - 8U) : (pin - 14U));
+}
+
+/* =============================== Digital I/O =============================== */
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  volatile uint8_t *ddr = portModeRegister(digitalPinToPort(pin));
+  if (mode == OUTPUT)
+  {
+    *ddr |= digitalPinToBitMask(pin);
+  }
+  else
+  {
+    *ddr &= static_cast<uint8_t>(~digitalPinToBitMask(pin));
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+  volatile uint8_t *out = portOutputRegister(digitalPinToPort(pin));
+  if (level != LOW)
+  {
+    *out |= digitalPinToBitMask(pin);
+  }
+  else
+  {
+    *out &= static_cast<uint8_t>(~digitalPinToBitMask(pin));
+  }
+  if (host_on_trig != 0)
+  {
+    host_on_trig(pin, level);
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  const volatile uint8_t *in = portInputRegister(digitalPinToPort(pin));
+  return ((*in & digitalPinToBitMask(pin)) != 0U) ? HIGH : LOW;
+}
+
+void hostSetPin(uint8_t pin, uint8_t level)
+{
+  volatile uint8_t *in = portInputRegister(digitalPinToPort(pin));
+  if (level != LOW)
+  {
+    *in |= digitalPinToBitMask(pin);
+  }
+  else
+  {
+    *in &= static_cast<uint8_t>(~digitalPinToBitMask(pin));
+  }
+}
+
+int analogRead(uint8_t pin)
+{
+  (void)pin;
+  return 0;
+}
+
+/* ============================ External interrupts ========================== */
+
+static void (*s_ext_isr[2])(void) = { 0, 0 };
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+  return (pin == 2U) ? 0 : ((pin == 3U) ? 1 : NOT_AN_INTERRUPT);
+}
+
+void attachInterrupt(uint8_t irq, void (*isr)(void), int mode)
+{
+  (void)mode;
+  if (irq < 2U)
+  {
+    s_ext_isr[irq] = isr;
+  }
+}
+
+void detachInterrupt(uint8_t irq)
+{
+  if (irq < 2U)
+  {
+    s_ext_isr[irq] = 0;
+  }
+}
+
+void (*hostExtIsr(uint8_t irq))(void)
+{
+  return (irq < 2U) ? s_ext_isr[irq] : 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file host_sr04.hpp
+ * @brief Host model of one HC-SR04 module wired to a driver's ECHO pin.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * The model watches the driver's shot mark (getLastShotTimestampUs(); drivers mark
+ * the shot right before the TRIG pulse) and drives the ECHO input like the module:
+ * - ECHO rises HOST_SR04_LATENCY_US after the trigger (burst sent, listening starts);
+ * - it falls at the first acoustic arrival after that, or HOST_SR04_NO_ECHO_US later
+ *   when nothing comes back.
+ * Arrivals come from every reflector of every burst still in the air, so a far wall
+ * hit by the previous burst can end the current pulse early: the "ghost" distance the
+ * adaptive cycle must avoid. Round trips are given in microseconds and may change
+ * between shots (moving target, temperature); a reflector mask, latched per burst,
+ * models weak targets that do not answer every burst.
+ *
+ * service() must run on every micros() call (host_on_micros) so busy-waiting drivers
+ * see the edges at the right time; set host_micros_step so their loops advance time.
+ * It reports ECHO changes, so the simulator can call the driver's pin-change ISR.
+ */
+
+#ifndef HOST_SR04_HPP_
+#define HOST_SR04_HPP_
+
+#include "hcsr04.hpp"
+
+/** @brief TRIG -> ECHO rising edge (burst transmission), us. */
+#define HOST_SR04_LATENCY_US   (450UL)
+
+/** @brief ECHO high time when no echo is heard, us (module-side timeout). */
+#define HOST_SR04_NO_ECHO_US   (38000UL)
+
+/** @brief Reflectors per module. */
+#define HOST_SR04_REFLECTORS   (4U)
+
+/** @brief Bursts remembered (older ones are assumed attenuated). */
+#define HOST_SR04_BURSTS       (4U)
+
+class HostSr04
+{
+public:
+  HostSr04(const IHCSR04 &driver, uint8_t echo_pin) :
+    m_driver(driver),
+    m_echo_pin(echo_pin),
+    m_count(0U),
+    m_mask(0xFFU),
+    m_seen_shot_us(driver.getLastShotTimestampUs()),
+    m_rise_us(0UL),
+    m_fall_us(0UL),
+    m_shots(0UL),
+    m_active(false)
+  {
+    for (uint8_t i = 0U; i < HOST_SR04_BURSTS; i++)
+    {
+      m_burst_us[i] = 0UL;
+      m_burst_mask[i] = 0U;
+    }
+  }
+
+  /** @brief Set reflector i's round trip (us); the first one is the intended target. */
+  void setReflector(uint8_t i, unsigned long round_trip_us)
+  {
+    if (i < HOST_SR04_REFLECTORS)
+    {
+      m_rt_us[i] = round_trip_us;
+      if (i >= m_count)
+      {
+        m_count = static_cast<uint8_t>(i + 1U);
+      }
+    }
+  }
+
+  /** @brief Reflectors (bit i = reflector i) answering the bursts from now on. */
+  void setMask(uint8_t mask) { m_mask = mask; }
+
+  /** @brief Shots seen since construction. */
+  unsigned long shots(void) const { return m_shots; }
+
+  /** @brief ECHO high time of the last shot as generated by the model (us). */
+  unsigned long lastPulseUs(void) const { return m_fall_us - m_rise_us; }
+
+  /**
+   * @brief Advance the module to host_now_us.
+   * @return true if ECHO changed level.
+   */
+  bool service(void)
+  {
+    const unsigned long shot_us = m_driver.getLastShotTimestampUs();
+    if (shot_us != m_seen_shot_us)
+    {
+      m_seen_shot_us = shot_us;
+      startShot_(shot_us);
+    }
+
+    uint8_t level = LOW;
+    if ((m_active == true) && (host_now_us >= m_rise_us))
+    {
+      if (host_now_us < m_fall_us)
+      {
+        level = HIGH;
+      }
+      else
+      {
+        m_active = false;
+      }
+    }
+    const bool changed = (digitalRead(m_echo_pin) != level);
+    hostSetPin(m_echo_pin, level);
+    return changed;
+  }
+
+private:
+  void startShot_(unsigned long shot_us)
+  {
+    /* Remember this burst (oldest slot replaced). */
+    for (uint8_t i = HOST_SR04_BURSTS - 1U; i > 0U; i--)
+    {
+      m_burst_us[i] = m_burst_us[i - 1U];
+      m_burst_mask[i] = m_burst_mask[i - 1U];
+    }
+    m_burst_us[0] = shot_us;
+    m_burst_mask[0] = m_mask;
+
+    /* Listening starts after the burst; the first arrival of any burst ends it. */
+    m_rise_us = shot_us + HOST_SR04_LATENCY_US;
+    m_fall_us = m_rise_us + HOST_SR04_NO_ECHO_US;
+    for (uint8_t b = 0U; b < HOST_SR04_BURSTS; b++)
+    {
+      for (uint8_t r = 0U; r < m_count; r++)
+      {
+        if ((m_burst_mask[b] & (1U << r)) == 0U)
+        {
+          continue;
+        }
+        const unsigned long arrival_us = m_burst_us[b] + HOST_SR04_LATENCY_US + m_rt_us[r];
+        if ((arrival_us > m_rise_us) && (arrival_us < m_fall_us))
+        {
+          m_fall_us = arrival_us;
+        }
+      }
+    }
+    m_active = true;
+    m_shots++;
+  }
+
+  const IHCSR04 &m_driver;
+  uint8_t        m_echo_pin;
+  uint8_t        m_count;
+  uint8_t        m_mask;
+  unsigned long  m_rt_us[HOST_SR04_REFLECTORS];
+  unsigned long  m_burst_us[HOST_SR04_BURSTS];
+  uint8_t        m_burst_mask[HOST_SR04_BURSTS];   /**< 0: slot unused. */
+  unsigned long  m_seen_shot_us;
+  unsigned long  m_rise_us;
+  unsigned long  m_fall_us;
+  unsigned long  m_shots;
+  bool           m_active;
+};
+
+#endif /* HOST_SR04_HPP_ */
@@ -0,0 +1,197 @@
+/**
+ * @file sim_adaptive.cpp
+ * @brief Sample rate and ghost readings of the echo-aware adaptive cycle (setAdaptiveCycle()).
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * Real drivers (HCSR04_Polling, and HCSR04_PCInt with its pin-change ISR) read a
+ * HostSr04 module for 10 simulated seconds, called back to back from loop().
+ *
+ * 1) Rates: one target, nothing else in the scene, 60 ms fixed cycle vs the adaptive
+ *    cycle with a 25 ms and a 10 ms ringdown guard (README of Esercizio3).
+ * 2) Ghosts: a weak target at 50 cm answering half of the bursts, in front of a wall at
+ *    3 m (17.5 ms round trip). A reading is a ghost when it matches neither the target
+ *    nor the wall: the echo of an older burst ended the pulse.
+ *
+ * Exit status 1 if any ghost is read with the fixed cycle or with a guard covering the
+ * wall, or if the short guard shows none (the scene would then prove nothing).
+ */
+
+#include <stdio.h>
+#include "hcsr04_polling.hpp"
+#include "hcsr04_pcint.hpp"
+#include "host_sr04.hpp"
+
+ISR(PCINT0_vect);
+
+/* ================================== Model ================================== */
+
+static const unsigned long RUN_US = 10000000UL;
+static const unsigned long MATCH_US = 100UL;    /* +-1.7 cm */
+
+static HostSr04 *s_module = 0;
+static bool s_pin_change_isr = false;
+static uint32_t s_rng = 0x12345678UL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+static void serviceModule(void)
+{
+  if ((s_module->service() == true) && (s_pin_change_isr == true))
+  {
+    PCINT0_vect();
+  }
+}
+
+static unsigned long roundTripUs(unsigned long cm)
+{
+  /* 343 m/s: 58.3 us per cm of range. */
+  return (cm * 20000UL + 171UL) / 343UL;
+}
+
+struct Scene
+{
+  unsigned long target_cm;
+  unsigned long wall_cm;        /* 0: no wall */
+  unsigned      target_hit_pct; /* bursts the target answers */
+};
+
+struct Outcome
+{
+  double rate_hz;      /* HCSR04_OK readings per second */
+  double ghost_pct;    /* of OK readings */
+  unsigned long ghosts;
+};
+
+static bool matches(unsigned long echo_us, unsigned long rt_us)
+{
+  return (echo_us + MATCH_US >= rt_us) && (echo_us <= rt_us + MATCH_US);
+}
+
+/* guard_us 0: fixed 60 ms cycle. */
+static Outcome runCase(IHCSR04 &drv, HostSr04 &module, bool pin_change, const Scene &scene,
+                       unsigned long guard_us)
+{
+  const unsigned long target_rt = roundTripUs(scene.target_cm);
+  const unsigned long wall_rt = roundTripUs(scene.wall_cm);
+  module.setReflector(0U, target_rt);
+  if (scene.wall_cm != 0UL)
+  {
+    module.setReflector(1U, wall_rt);
+  }
+
+  s_module = &module;
+  s_pin_change_isr = pin_change;
+  host_on_micros = serviceModule;
+  host_micros_step = 1UL;
+  host_now_us += 1000000UL;
+
+  (void)drv.begin();
+  (void)drv.setAdaptiveCycle(guard_us != 0UL, (guard_us != 0UL) ? guard_us : HCSR04_RANGE_GUARD_US);
+
+  unsigned long ok = 0UL;
+  unsigned long ghosts = 0UL;
+  const unsigned long end_us = host_now_us + RUN_US;
+  while (host_now_us < end_us)
+  {
+    uint8_t mask = (scene.wall_cm != 0UL) ? 0x02U : 0x00U;
+    if ((nextRandom() % 100U) < scene.target_hit_pct)
+    {
+      mask |= 0x01U;
+    }
+    module.setMask(mask);
+
+    unsigned long echo_us = 0UL;
+    const HCSR04_Status st = drv.readRawUs(echo_us);
+    if (st == HCSR04_OK)
+    {
+      ok++;
+      if (!matches(echo_us, target_rt) && ((scene.wall_cm == 0UL) || !matches(echo_us, wall_rt)))
+      {
+        ghosts++;
+      }
+    }
+    host_now_us += 5UL;
+  }
+
+  host_on_micros = 0;
+  Outcome out;
+  out.rate_hz = static_cast<double>(ok) / (static_cast<double>(RUN_US) / 1.0e6);
+  out.ghosts = ghosts;
+  out.ghost_pct = (ok != 0UL) ? ((100.0 * static_cast<double>(ghosts)) / static_cast<double>(ok)) : 0.0;
+  return out;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const unsigned long TARGETS_CM[] = { 20UL, 50UL, 100UL, 200UL };
+  static const unsigned long GUARDS_US[] = { 0UL, 25000UL, 10000UL };
+  int rc = 0;
+
+  HCSR04_Polling polling(9U, 8U);
+  HostSr04 polling_module(polling, 8U);
+  HCSR04_PCInt pcint(11U, 10U);
+  HostSr04 pcint_module(pcint, 10U);
+
+  printf("1) Readings/s, single target (HCSR04_Polling)\n\n");
+  printf("  Target | 60 ms fixed | Guard 25 ms | Guard 10 ms\n");
+  printf("  -------+-------------+-------------+------------\n");
+  for (size_t t = 0U; t < (sizeof(TARGETS_CM) / sizeof(TARGETS_CM[0])); t++)
+  {
+    const Scene scene = { TARGETS_CM[t], 0UL, 100U };
+    printf("  %3lu cm |", TARGETS_CM[t]);
+    for (size_t g = 0U; g < (sizeof(GUARDS_US) / sizeof(GUARDS_US[0])); g++)
+    {
+      const Outcome o = runCase(polling, polling_module, false, scene, GUARDS_US[g]);
+      printf("   %5.1f     |", o.rate_hz);
+      if (o.ghosts != 0UL)
+      {
+        rc = 1;
+      }
+    }
+    printf("\n");
+  }
+
+  printf("\n2) Ghosts: target 50 cm answering 50 %% of bursts, wall at 300 cm (17.5 ms)\n\n");
+  printf("  Driver  | Cycle         | Readings/s | Ghost readings\n");
+  printf("  --------+---------------+------------+---------------\n");
+  const Scene ghost_scene = { 50UL, 300UL, 50U };
+  for (uint8_t d = 0U; d < 2U; d++)
+  {
+    for (size_t g = 0U; g < (sizeof(GUARDS_US) / sizeof(GUARDS_US[0])); g++)
+    {
+      const Outcome o = (d == 0U) ? runCase(polling, polling_module, false, ghost_scene, GUARDS_US[g])
+                                  : runCase(pcint, pcint_module, true, ghost_scene, GUARDS_US[g]);
+      char cycle[32];
+      if (GUARDS_US[g] == 0UL)
+      {
+        snprintf(cycle, sizeof(cycle), "60 ms fixed");
+      }
+      else
+      {
+        snprintf(cycle, sizeof(cycle), "guard %2lu ms", GUARDS_US[g] / 1000UL);
+      }
+      printf("  %-7s | %-13s |   %5.1f    | %5.1f %% (%lu)\n", (d == 0U) ? "polling" : "pcint",
+             cycle, o.rate_hz, o.ghost_pct, o.ghosts);
+
+      const bool guard_covers_wall = (GUARDS_US[g] == 0UL) || (GUARDS_US[g] >= roundTripUs(ghost_scene.wall_cm));
+      if (guard_covers_wall ? (o.ghosts != 0UL) : (o.ghosts == 0UL))
+      {
+        rc = 1;
+      }
+    }
+  }
+
+  printf("\n%s\n", (rc == 0) ? "PASS: no ghost while the guard covers the farthest reflector" : "FAIL");
+  return rc;
+}
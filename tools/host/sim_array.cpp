@@ -0,0 +1,498 @@
+/**
+ * @file sim_array.cpp
+ * @brief Sweep time and latency of HCSR04_Array over rings of non-blocking sensors.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * The scheduler is the real HCSR04_Array; the sensors are ModelSensor, an IHCSR04 that
+ * behaves like the interrupt-driven drivers: readRawUs() never blocks, a shot starts
+ * when canStartShot_() allows it (own min cycle) and its result is ready
+ * MODEL_LATENCY_US + echo later, or after the driver timeout when nothing answers.
+ * (The UNO has no pins for 12 real sensors; what is measured here is the scheduler.)
+ *
+ * N sensors evenly spaced on a ring, service() every 50 us for 3 s, 10 ms guard,
+ * 30 ms timeout, 60 ms min cycle. Columns:
+ * - read() loop: one sensor per 60 ms slot (N x min cycle, the plain sketch; computed);
+ * - all conflict: buildConflicts(181), so every pair conflicts (serialized scheduler);
+ * - scheduled: buildConflicts(60), sensors 60 deg apart or more fire together;
+ * - latency: shot start -> result, averaged over the sensors (scheduled layout).
+ *
+ * Collect-and-trigger sensors: ModelSensor can also behave like HCSR04_Interrupt,
+ * whose readRawUs() starts the next shot and pops the buffered result in one call; with
+ * collectRawUs() (the driver's own) or readRawUs() only (a custom driver without it).
+ * A 5 ms min cycle lets every collecting read re-trigger. Checked at every service():
+ * no two conflicting sensors in flight at once, and every result filed under the shot
+ * that produced it (HCSR04_ArrayResult::shot_us).
+ *
+ * Rates (setTask()): echoes at 1 m for 10 s; a front sensor (setAdaptiveCycle(true,
+ * 10000), 25 ms min cycle) asks 30 Hz at priority 1, six side sensors at 45 deg steps
+ * ask a common rate at priority 0. Misses are in percent of the released side jobs.
+ *
+ * The rate scenarios are repeated with collect-and-trigger sides at a 5 ms min cycle.
+ * Every shot start must serve exactly one released job: shots + misses equals the jobs
+ * released during the run (give or take the one still pending). The sides read by
+ * readRawUs() only show what a driver without collectRawUs() costs.
+ *
+ * Exit status 1 if the scheduled sweep is slower than the serialized one, if a sensor
+ * with echoes does not reach its own min cycle, if conflicting sensors overlap or a
+ * result gets another shot's timestamp, if collectRawUs() changes the schedule, if the
+ * front sensor loses its rate, if the sides miss deadlines in a layout that is not
+ * overloaded, or if shots and misses do not add up to the released jobs.
+ */
+
+#include <stdio.h>
+#include "hcsr04_array.hpp"
+
+/* ================================== Model ================================== */
+
+static const unsigned long MODEL_LATENCY_US = 500UL;    /* TRIG -> listening */
+static const unsigned long ECHO_1M_US = 5830UL;
+static const unsigned long SERVICE_US = 50UL;
+static const unsigned long RUN_US = 3000000UL;
+static const unsigned long MIN_CYCLE_US = 60000UL;
+static const unsigned long IRQ_MIN_CYCLE_US = 5000UL;  /* below every result latency */
+
+/* How readRawUs()/collectRawUs() behave. */
+typedef enum
+{
+  STYLE_PHASED = 0,   /* pin change / input capture: a finished shot is handed over first */
+  STYLE_IRQ,          /* HCSR04_Interrupt: readRawUs() triggers and pops, collectRawUs() pops */
+  STYLE_IRQ_NO_DRAIN  /* same readRawUs(), default collectRawUs() (e.g. a decorator over it) */
+} ModelStyle;
+
+class ModelSensor : public IHCSR04
+{
+public:
+  ModelSensor(void) :
+    IHCSR04(9U, 8U),
+    m_style(STYLE_PHASED),
+    m_echo_us(ECHO_1M_US),
+    m_answers(true),
+    m_busy(false),
+    m_ready_us(0UL),
+    m_shot_us(0UL),
+    m_buffered(false),
+    m_buf_shot_us(0UL),
+    m_buf_answered(false),
+    m_popped_shot_us(0UL),
+    m_shots(0UL)
+  {
+  }
+
+  void setScene(bool answers, unsigned long echo_us)
+  {
+    m_answers = answers;
+    m_echo_us = echo_us;
+  }
+
+  void setStyle(ModelStyle style) { m_style = style; }
+
+  unsigned long shots(void) const { return m_shots; }
+
+  /* Burst out or listening at now_us. */
+  bool inFlight(unsigned long now_us) const { return m_busy && (now_us < m_ready_us); }
+
+  /* Shot start of the last result handed over. */
+  unsigned long poppedShotUs(void) const { return m_popped_shot_us; }
+
+  HCSR04_Status begin(void) { return HCSR04_OK; }
+
+  HCSR04_Status read(float &out_cm)
+  {
+    out_cm = 0.0F;
+    return HCSR04_ERR_NOT_READY;
+  }
+
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    return (m_style == STYLE_PHASED) ? phased_(out_echo_us) : irq_(out_echo_us, true);
+  }
+
+  HCSR04_Status collectRawUs(unsigned long &out_echo_us)
+  {
+    return (m_style == STYLE_IRQ) ? irq_(out_echo_us, false) : readRawUs(out_echo_us);
+  }
+
+private:
+  void fire_(unsigned long now)
+  {
+    markShotStart_();
+    m_busy = true;
+    m_shots++;
+    m_shot_us = now;
+    m_ready_us = now + (m_answers ? (MODEL_LATENCY_US + m_echo_us) : getTimeoutUs());
+  }
+
+  HCSR04_Status phased_(unsigned long &out_echo_us)
+  {
+    HCSR04_Status status = HCSR04_ERR_NOT_READY;
+    const unsigned long now = micros();
+    if (m_busy == false)
+    {
+      if (canStartShot_() == HCSR04_OK)
+      {
+        fire_(now);
+      }
+    }
+    else if (now >= m_ready_us)
+    {
+      m_busy = false;
+      m_popped_shot_us = m_shot_us;
+      if (m_answers)
+      {
+        noteEchoEnd_(now);
+        out_echo_us = m_echo_us;
+        status = HCSR04_OK;
+      }
+      else
+      {
+        status = HCSR04_ERR_TIMEOUT_ECHO_START;
+      }
+    }
+    else
+    {
+      /* Still in flight. */
+    }
+    return status;
+  }
+
+  /* The ISRs buffer the finished shot; the read then triggers (if allowed) and pops. */
+  HCSR04_Status irq_(unsigned long &out_echo_us, bool fire)
+  {
+    HCSR04_Status status = HCSR04_ERR_NOT_READY;
+    const unsigned long now = micros();
+    if (m_busy && (now >= m_ready_us))
+    {
+      m_busy = false;
+      m_buffered = true;
+      m_buf_shot_us = m_shot_us;
+      m_buf_answered = m_answers;
+      if (m_answers)
+      {
+        noteEchoEnd_(m_ready_us);
+      }
+    }
+    if (fire && (m_busy == false) && (canStartShot_() == HCSR04_OK))
+    {
+      fire_(now);
+    }
+    if (m_buffered)
+    {
+      m_buffered = false;
+      m_popped_shot_us = m_buf_shot_us;
+      if (m_buf_answered)
+      {
+        out_echo_us = m_echo_us;
+        status = HCSR04_OK;
+      }
+      else
+      {
+        status = HCSR04_ERR_TIMEOUT_ECHO_START;
+      }
+    }
+    return status;
+  }
+
+  ModelStyle    m_style;
+  unsigned long m_echo_us;
+  bool          m_answers;
+  bool          m_busy;
+  unsigned long m_ready_us;
+  unsigned long m_shot_us;
+  bool          m_buffered;       /* one finished shot waiting in the "ring" */
+  unsigned long m_buf_shot_us;
+  bool          m_buf_answered;
+  unsigned long m_popped_shot_us;
+  unsigned long m_shots;
+};
+
+struct SweepRow
+{
+  unsigned long sweep_us;
+  unsigned long latency_us;     /* average */
+  unsigned long min_shots;      /* slowest sensor */
+  unsigned long overlaps;       /* service() steps with two conflicting sensors in flight */
+  unsigned long wrong_shot;     /* results filed under another shot's shot_us */
+};
+
+template <uint8_t N>
+static SweepRow runRing(bool echoes, uint16_t min_sep_deg, ModelStyle style, unsigned long min_cycle_us)
+{
+  ModelSensor sensors[N];
+  IHCSR04 *ptrs[N];
+  for (uint8_t i = 0U; i < N; i++)
+  {
+    sensors[i].setScene(echoes, ECHO_1M_US);
+    sensors[i].setStyle(style);
+    (void)sensors[i].setMinCycleUs(min_cycle_us);
+    ptrs[i] = &sensors[i];
+  }
+
+  host_now_us += 1000000UL;
+  HCSR04_Array<N> array(ptrs);
+  (void)array.begin();
+  for (uint8_t i = 0U; i < N; i++)
+  {
+    (void)array.setHeading(i, static_cast<int16_t>((360U * i) / N));
+  }
+  array.buildConflicts(min_sep_deg);
+
+  SweepRow row = { 0UL, 0UL, 0UL, 0UL, 0UL };
+  uint16_t seq[N] = { 0U };
+  const unsigned long end_us = host_now_us + RUN_US;
+  while (host_now_us < end_us)
+  {
+    host_now_us += SERVICE_US;
+    array.service();
+
+    for (uint8_t i = 0U; i < N; i++)
+    {
+      HCSR04_ArrayResult r;
+      if (array.getResult(i, r) && (r.seq != seq[i]))
+      {
+        seq[i] = r.seq;
+        if (r.shot_us != sensors[i].poppedShotUs())
+        {
+          row.wrong_shot++;
+        }
+      }
+      for (uint8_t j = static_cast<uint8_t>(i + 1U); j < N; j++)
+      {
+        if (((array.getConflictMask(i) & static_cast<uint16_t>(1U << j)) != 0U) &&
+            sensors[i].inFlight(host_now_us) && sensors[j].inFlight(host_now_us))
+        {
+          row.overlaps++;
+        }
+      }
+    }
+  }
+
+  row.sweep_us = array.getSweepUs();
+  row.min_shots = sensors[0].shots();
+  for (uint8_t i = 0U; i < N; i++)
+  {
+    HCSR04_ArrayResult r;
+    if (array.getResult(i, r))
+    {
+      row.latency_us += r.latency_us;
+    }
+    if (sensors[i].shots() < row.min_shots)
+    {
+      row.min_shots = sensors[i].shots();
+    }
+  }
+  row.latency_us /= N;
+  return row;
+}
+
+template <uint8_t N>
+static bool printRing(bool echoes)
+{
+  const SweepRow serial = runRing<N>(echoes, 181U, STYLE_PHASED, MIN_CYCLE_US);
+  const SweepRow sched = runRing<N>(echoes, 60U, STYLE_PHASED, MIN_CYCLE_US);
+  printf("  %2u | %-4s | %6lu ms   | %7.0f ms   | %6.0f ms | %5.1f ms\n", N,
+         echoes ? "1 m" : "none", (N * MIN_CYCLE_US) / 1000UL,
+         static_cast<double>(serial.sweep_us) / 1000.0, static_cast<double>(sched.sweep_us) / 1000.0,
+         static_cast<double>(sched.latency_us) / 1000.0);
+
+  bool ok = (sched.sweep_us <= serial.sweep_us) && (serial.overlaps == 0UL) && (sched.overlaps == 0UL) &&
+            (serial.wrong_shot == 0UL) && (sched.wrong_shot == 0UL);
+  if (echoes)
+  {
+    /* Every sensor at its own min cycle: RUN_US / 60 ms shots, give or take one. */
+    ok = ok && ((sched.min_shots + 1UL) >= (RUN_US / MIN_CYCLE_US));
+  }
+  return ok;
+}
+
+/* Collect-and-trigger sensors: no conflicting pair in flight, every result under its own shot. */
+template <uint8_t N>
+static bool printIrqRing(bool echoes, uint16_t min_sep_deg)
+{
+  const SweepRow ref = runRing<N>(echoes, min_sep_deg, STYLE_PHASED, IRQ_MIN_CYCLE_US);
+  const SweepRow irq = runRing<N>(echoes, min_sep_deg, STYLE_IRQ, IRQ_MIN_CYCLE_US);
+  const SweepRow raw = runRing<N>(echoes, min_sep_deg, STYLE_IRQ_NO_DRAIN, IRQ_MIN_CYCLE_US);
+  char raw_sweep[16];
+  if (raw.min_shots == 0UL)
+  {
+    snprintf(raw_sweep, sizeof(raw_sweep), "starved");
+  }
+  else
+  {
+    snprintf(raw_sweep, sizeof(raw_sweep), "%.0f ms", static_cast<double>(raw.sweep_us) / 1000.0);
+  }
+  printf("  %2u | %-4s | %3u deg    | %6.0f ms | %6.0f ms / %lu / %lu    | %-7s / %lu / %lu\n", N,
+         echoes ? "1 m" : "none", min_sep_deg, static_cast<double>(ref.sweep_us) / 1000.0,
+         static_cast<double>(irq.sweep_us) / 1000.0, irq.overlaps, irq.wrong_shot, raw_sweep,
+         raw.overlaps, raw.wrong_shot);
+
+  return (irq.sweep_us == ref.sweep_us) && (irq.min_shots == ref.min_shots) &&
+         (irq.overlaps == 0UL) && (irq.wrong_shot == 0UL) &&
+         (raw.overlaps == 0UL) && (raw.wrong_shot == 0UL);
+}
+
+struct RateRow
+{
+  double front_hz;
+  double side_hz;       /* average of the sides */
+  double side_miss_pct;
+  unsigned long job_err; /* worst |shots + misses - released jobs| of a periodic sensor */
+};
+
+static RateRow runRates(bool all_conflict, unsigned long side_period_us, ModelStyle style,
+                        unsigned long side_min_cycle_us)
+{
+  static const uint8_t SIDES = 6U;
+  static const unsigned long RATE_RUN_US = 10000000UL;
+  static const unsigned long FRONT_PERIOD_US = 33333UL;
+  ModelSensor sensors[SIDES + 1U];
+  IHCSR04 *ptrs[SIDES + 1U];
+  for (uint8_t i = 0U; i <= SIDES; i++)
+  {
+    sensors[i].setStyle(style);
+    if (i != 0U)
+    {
+      (void)sensors[i].setMinCycleUs(side_min_cycle_us);
+    }
+    ptrs[i] = &sensors[i];
+  }
+  (void)sensors[0].setMinCycleUs(25000UL);
+  (void)sensors[0].setAdaptiveCycle(true, 10000UL);
+
+  host_now_us += 1000000UL;
+  HCSR04_Array<SIDES + 1U> array(ptrs);
+  (void)array.begin();
+  (void)array.setHeading(0U, 0);
+  (void)array.setTask(0U, FRONT_PERIOD_US, 1U);
+  for (uint8_t i = 1U; i <= SIDES; i++)
+  {
+    /* 45, 90, 135, -135, -90, -45 deg */
+    const int16_t heading = static_cast<int16_t>(45 * ((i < 4U) ? static_cast<int16_t>(i) : static_cast<int16_t>(i - 7)));
+    (void)array.setHeading(i, heading);
+    (void)array.setTask(i, side_period_us, 0U);
+  }
+  array.buildConflicts(all_conflict ? 181U : 60U);
+
+  const unsigned long end_us = host_now_us + RATE_RUN_US;
+  while (host_now_us < end_us)
+  {
+    host_now_us += SERVICE_US;
+    array.service();
+  }
+
+  const double run_s = static_cast<double>(RATE_RUN_US) / 1.0e6;
+  unsigned long side_shots = 0UL;
+  unsigned long side_misses = 0UL;
+  RateRow row;
+  row.job_err = 0UL;
+  for (uint8_t i = 0U; i <= SIDES; i++)
+  {
+    /* Jobs released at setTask() + k * period up to the end of the run; the last one may
+       still be pending. Every shot start serves one released job. */
+    const unsigned long period_us = (i == 0U) ? FRONT_PERIOD_US : side_period_us;
+    const unsigned long jobs = (RATE_RUN_US / period_us) + 1UL;
+    const unsigned long accounted = sensors[i].shots() + array.getDeadlineMisses(i);
+    const unsigned long err = (accounted > jobs) ? (accounted - jobs) : (jobs - accounted);
+    row.job_err = (err > row.job_err) ? err : row.job_err;
+    if (i != 0U)
+    {
+      side_shots += sensors[i].shots();
+      side_misses += array.getDeadlineMisses(i);
+    }
+  }
+  const double side_jobs = static_cast<double>(SIDES) * (static_cast<double>(RATE_RUN_US) / static_cast<double>(side_period_us));
+
+  row.front_hz = static_cast<double>(sensors[0].shots()) / run_s;
+  row.side_hz = static_cast<double>(side_shots) / static_cast<double>(SIDES) / run_s;
+  row.side_miss_pct = (100.0 * static_cast<double>(side_misses)) / side_jobs;
+  return row;
+}
+
+static bool printRates(const char *layout, bool all_conflict, unsigned long side_hz, bool overloaded)
+{
+  const RateRow row = runRates(all_conflict, 1000000UL / side_hz, STYLE_PHASED, MIN_CYCLE_US);
+  printf("  %-36s | %3lu Hz | %5.1f Hz | %6.1f Hz | %6.0f %%\n", layout, side_hz, row.front_hz,
+         row.side_hz, row.side_miss_pct);
+  bool ok = (row.front_hz >= 29.5) && (row.job_err <= 1UL);
+  if (!overloaded)
+  {
+    ok = ok && (row.side_miss_pct == 0.0);
+  }
+  return ok;
+}
+
+/* Same rates with collect-and-trigger sides (5 ms min cycle: every collecting read may
+   re-trigger). With collectRawUs() nothing may change, jobs included. */
+static bool printIrqRates(const char *layout, bool all_conflict, unsigned long side_hz)
+{
+  static const char *const STYLES[] = { "phased", "collectRawUs()", "readRawUs() only" };
+  RateRow rows[3];
+  bool ok = true;
+  for (uint8_t k = 0U; k < 3U; k++)
+  {
+    rows[k] = runRates(all_conflict, 1000000UL / side_hz, static_cast<ModelStyle>(k), IRQ_MIN_CYCLE_US);
+    char job_err[8];
+    if (k == static_cast<uint8_t>(STYLE_IRQ_NO_DRAIN))
+    {
+      snprintf(job_err, sizeof(job_err), "-");  /* extra shots serve no job */
+    }
+    else
+    {
+      snprintf(job_err, sizeof(job_err), "%lu", rows[k].job_err);
+    }
+    printf("  %-34s | %-16s | %3lu Hz | %5.1f Hz | %6.1f Hz | %6.0f %%     | %s\n", layout, STYLES[k], side_hz,
+           rows[k].front_hz, rows[k].side_hz, rows[k].side_miss_pct, job_err);
+  }
+  ok = (rows[0].front_hz >= 29.5) && (rows[0].job_err <= 1UL) &&
+       (rows[1].front_hz == rows[0].front_hz) && (rows[1].side_hz == rows[0].side_hz) &&
+       (rows[1].side_miss_pct == rows[0].side_miss_pct) && (rows[1].job_err <= 1UL);
+  return ok;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  host_micros_step = 0UL;
+
+  printf("Ring of N sensors, service() every 50 us, 10 ms guard, 30 ms timeout, 60 ms min cycle\n\n");
+  printf("   N | Echo | read() loop | All conflict | Scheduled | Latency\n");
+  printf("  ---+------+-------------+--------------+-----------+---------\n");
+  bool ok = true;
+  for (uint8_t e = 0U; e < 2U; e++)
+  {
+    const bool echoes = (e == 0U);
+    ok = printRing<6>(echoes) && ok;
+    ok = printRing<8>(echoes) && ok;
+    ok = printRing<12>(echoes) && ok;
+  }
+
+  printf("\nCollect-and-trigger sensors (HCSR04_Interrupt model), 5 ms min cycle: sweep / overlapping steps / wrong shot_us\n\n");
+  printf("   N | Echo | Separation | Phased    | collectRawUs()         | readRawUs() only\n");
+  printf("  ---+------+------------+-----------+------------------------+------------------\n");
+  for (uint8_t e = 0U; e < 2U; e++)
+  {
+    const bool echoes = (e == 0U);
+    ok = printIrqRing<8>(echoes, 60U) && ok;
+    ok = printIrqRing<8>(echoes, 181U) && ok;
+    ok = printIrqRing<12>(echoes, 60U) && ok;
+  }
+
+  printf("\nRates: front 30 Hz (prio 1), 6 sides (prio 0), echoes at 1 m, 10 s\n\n");
+  printf("  Layout                               | Sides  | Front    | Each side | Side misses\n");
+  printf("  -------------------------------------+--------+----------+-----------+------------\n");
+  ok = printRates("front + 6 sides at 45 deg steps", false, 5UL, false) && ok;
+  ok = printRates("front + 6 sides, one conflict set", true, 5UL, false) && ok;
+  ok = printRates("front + 6 sides, one conflict set", true, 10UL, true) && ok;
+  ok = printRates("front + 6 sides at 45 deg steps", false, 20UL, true) && ok;
+
+  printf("\nRates with collect-and-trigger sides (5 ms min cycle); job error: |shots + misses - released jobs|\n\n");
+  printf("  Layout                             | Sides read by    | Sides  | Front    | Each side | Side misses | Job error\n");
+  printf("  -----------------------------------+------------------+--------+----------+-----------+-------------+----------\n");
+  ok = printIrqRates("front + 6 sides at 45 deg steps", false, 10UL) && ok;
+  ok = printIrqRates("front + 6 sides, one conflict set", true, 5UL) && ok;
+  ok = printIrqRates("front + 6 sides, one conflict set", true, 10UL) && ok;
+
+  printf("\n%s\n", ok ? "PASS: sweeps, min cycles and task rates as expected" : "FAIL");
+  return ok ? 0 : 1;
+}
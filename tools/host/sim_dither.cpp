@@ -0,0 +1,312 @@
+/**
+ * @file sim_dither.cpp
+ * @brief Crosstalk ghosts with and without HCSR04_Dither (jitter + consistency check).
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * Four sensors face one wall at 1 m (true echo ECHO_US) and hear each other's bursts
+ * over a 1.1 m path (CROSS_US after the foreign shot). Each is a CrosstalkSensor: an
+ * IHCSR04 that fires whenever canStartShot_() allows (60 ms min cycle) and reports the
+ * earliest arrival in its listening window: a foreign burst landing at least BLANK_US
+ * after its own TRIG and before the wall echo, or else the wall. The real HCSR04_Dither
+ * wraps each one (distinct seeds, 300 us tolerance). Sensors start 2 ms apart, loop()
+ * polls every 50 us, 4000 shots per sensor.
+ *
+ * Percentages are of all shots. A ghost is any reading that is not the wall; it is
+ * counted as accepted only if it reached the caller with an error above 10 cm.
+ *
+ * Second table: the sensors behave like HCSR04_Interrupt (the result is buffered at the
+ * echo end; readRawUs() triggers if allowed and pops it in the same call, collectRawUs()
+ * only pops) with the adaptive cycle (2 ms guard), and loop() polls every 3 ms, so the
+ * guard has often elapsed when a result is collected. "Undelayed" shots were started by
+ * the call that handed over the previous result, i.e. without the random delay.
+ *
+ * Exit status 1 if dithering does not cut the accepted ghosts at least tenfold compared
+ * with the fixed cycle, or if any dithered shot of the second table is undelayed.
+ */
+
+#include <stdio.h>
+#include "hcsr04_dither.hpp"
+
+/* ================================== Model ================================== */
+
+static const uint8_t SENSORS = 4U;
+static const unsigned long ECHO_US = 5830UL;     /* wall at 1 m */
+static const unsigned long CROSS_US = 6413UL;    /* 1.1 m neighbour path */
+static const unsigned long BLANK_US = 300UL;     /* own burst ringdown */
+static const unsigned long ERR_10CM_US = 600UL;
+static const unsigned long POLL_US = 50UL;
+static const unsigned long SHOTS = 4000UL;
+static const uint8_t LOG_LEN = 16U;
+static const unsigned long IRQ_GUARD_US = 2000UL;       /* adaptive cycle ringdown guard */
+static const unsigned long IRQ_POLL_US = 3000UL;        /* loop() busy with other work */
+
+/* Recent shots of every sensor, newest overwrites oldest. */
+static unsigned long s_log_us[LOG_LEN];
+static uint8_t s_log_id[LOG_LEN];
+static uint8_t s_log_next = 0U;
+static uint8_t s_log_count = 0U;
+
+class CrosstalkSensor : public IHCSR04
+{
+public:
+  explicit CrosstalkSensor(uint8_t id) :
+    IHCSR04(9U, 8U),
+    m_id(id),
+    m_irq(false),
+    m_busy(false),
+    m_ready_us(0UL),
+    m_echo_us(0UL),
+    m_buffered(false),
+    m_buf_echo_us(0UL),
+    m_shots(0UL),
+    m_ghosts(0UL),
+    m_undelayed(0UL)
+  {
+  }
+
+  /* true: behave like HCSR04_Interrupt (result buffered at the echo end; readRawUs()
+     triggers if allowed and pops, collectRawUs() only pops). */
+  void setInterruptStyle(bool irq) { m_irq = irq; }
+
+  unsigned long shots(void) const { return m_shots; }
+  unsigned long ghosts(void) const { return m_ghosts; }
+
+  /* Shots started by the same call that handed over the previous result. */
+  unsigned long undelayed(void) const { return m_undelayed; }
+
+  HCSR04_Status begin(void) { return HCSR04_OK; }
+
+  HCSR04_Status read(float &out_cm)
+  {
+    out_cm = 0.0F;
+    return HCSR04_ERR_NOT_READY;
+  }
+
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    HCSR04_Status status = HCSR04_ERR_NOT_READY;
+    if (m_irq)
+    {
+      status = irq_(out_echo_us, true);
+    }
+    else
+    {
+      status = canStartShot_();
+      if (status == HCSR04_OK)
+      {
+        const unsigned long echo_us = fire_();
+        noteEchoEnd_(micros() + echo_us);
+        out_echo_us = echo_us;
+      }
+    }
+    return status;
+  }
+
+  HCSR04_Status collectRawUs(unsigned long &out_echo_us)
+  {
+    return m_irq ? irq_(out_echo_us, false) : readRawUs(out_echo_us);
+  }
+
+private:
+  /* Start a shot now; returns its echo: the earliest foreign burst landing in the
+     listening window, or the wall. */
+  unsigned long fire_(void)
+  {
+    markShotStart_();
+    const unsigned long now = micros();
+    unsigned long echo_us = ECHO_US;
+    for (uint8_t i = 0U; i < s_log_count; i++)
+    {
+      const unsigned long arrival_us = s_log_us[i] + CROSS_US;
+      if ((s_log_id[i] != m_id) && (arrival_us >= (now + BLANK_US)) && ((arrival_us - now) < echo_us))
+      {
+        echo_us = arrival_us - now;
+      }
+    }
+
+    s_log_us[s_log_next] = now;
+    s_log_id[s_log_next] = m_id;
+    s_log_next = static_cast<uint8_t>((s_log_next + 1U) % LOG_LEN);
+    if (s_log_count < LOG_LEN)
+    {
+      s_log_count++;
+    }
+
+    m_shots++;
+    if (echo_us != ECHO_US)
+    {
+      m_ghosts++;
+    }
+    return echo_us;
+  }
+
+  HCSR04_Status irq_(unsigned long &out_echo_us, bool fire)
+  {
+    HCSR04_Status status = HCSR04_ERR_NOT_READY;
+    const unsigned long now = micros();
+    if (m_busy && (now >= m_ready_us))
+    {
+      m_busy = false;
+      m_buffered = true;
+      m_buf_echo_us = m_echo_us;
+      noteEchoEnd_(m_ready_us);
+    }
+    if (fire && (m_busy == false) && (canStartShot_() == HCSR04_OK))
+    {
+      m_echo_us = fire_();
+      m_busy = true;
+      m_ready_us = now + m_echo_us;
+      if (m_buffered)
+      {
+        m_undelayed++;
+      }
+    }
+    if (m_buffered)
+    {
+      m_buffered = false;
+      out_echo_us = m_buf_echo_us;
+      status = HCSR04_OK;
+    }
+    return status;
+  }
+
+  uint8_t       m_id;
+  bool          m_irq;
+  bool          m_busy;
+  unsigned long m_ready_us;
+  unsigned long m_echo_us;
+  bool          m_buffered;
+  unsigned long m_buf_echo_us;
+  unsigned long m_shots;
+  unsigned long m_ghosts;
+  unsigned long m_undelayed;
+};
+
+struct DitherRow
+{
+  double period_ms;
+  double ghost_pct;
+  double accepted_pct;
+  double valid_pct;
+  double undelayed_pct;
+};
+
+/* dither false: the bare sensors, no decorator at all.
+   irq: HCSR04_Interrupt-style sensors with the adaptive cycle, polled every IRQ_POLL_US. */
+static DitherRow runLayout(bool dither, unsigned long jitter_us, unsigned long tol_us, bool irq = false)
+{
+  CrosstalkSensor s0(0U), s1(1U), s2(2U), s3(3U);
+  CrosstalkSensor *sensors[SENSORS] = { &s0, &s1, &s2, &s3 };
+  const unsigned long poll_us = irq ? IRQ_POLL_US : POLL_US;
+  for (uint8_t i = 0U; i < SENSORS; i++)
+  {
+    sensors[i]->setInterruptStyle(irq);
+    (void)sensors[i]->setAdaptiveCycle(irq, IRQ_GUARD_US);
+  }
+  HCSR04_Dither d0(s0, 0x1234UL + 7UL), d1(s1, 0x2468UL + 7UL), d2(s2, 0x369CUL + 7UL), d3(s3, 0x48D0UL + 7UL);
+  HCSR04_Dither *dithers[SENSORS] = { &d0, &d1, &d2, &d3 };
+
+  s_log_next = 0U;
+  s_log_count = 0U;
+  host_now_us += 1000000UL;
+  const unsigned long t0 = host_now_us;
+  unsigned long start_us[SENSORS];
+  for (uint8_t i = 0U; i < SENSORS; i++)
+  {
+    dithers[i]->setJitterUs(jitter_us);
+    dithers[i]->setToleranceUs(tol_us);
+    (void)dithers[i]->begin();
+    start_us[i] = t0 + (2000UL * i);
+  }
+
+  unsigned long valid = 0UL;
+  unsigned long accepted = 0UL;
+  while (s0.shots() < SHOTS)
+  {
+    host_now_us += poll_us;
+    for (uint8_t i = 0U; i < SENSORS; i++)
+    {
+      if (host_now_us >= start_us[i])
+      {
+        unsigned long echo_us = 0UL;
+        const HCSR04_Status st = dither ? dithers[i]->readRawUs(echo_us) : sensors[i]->readRawUs(echo_us);
+        if (st == HCSR04_OK)
+        {
+          if (echo_us == ECHO_US)
+          {
+            valid++;
+          }
+          else if ((echo_us + ERR_10CM_US) < ECHO_US)
+          {
+            accepted++;
+          }
+          else
+          {
+            /* Ghost within 10 cm of the wall: harmless. */
+          }
+        }
+      }
+    }
+  }
+
+  unsigned long shots = 0UL;
+  unsigned long ghosts = 0UL;
+  unsigned long undelayed = 0UL;
+  for (uint8_t i = 0U; i < SENSORS; i++)
+  {
+    shots += sensors[i]->shots();
+    ghosts += sensors[i]->ghosts();
+    undelayed += sensors[i]->undelayed();
+  }
+  DitherRow row;
+  row.period_ms = static_cast<double>(host_now_us - t0) / 1000.0 / static_cast<double>(s0.shots());
+  row.ghost_pct = (100.0 * static_cast<double>(ghosts)) / static_cast<double>(shots);
+  row.accepted_pct = (100.0 * static_cast<double>(accepted)) / static_cast<double>(shots);
+  row.valid_pct = (100.0 * static_cast<double>(valid)) / static_cast<double>(shots);
+  row.undelayed_pct = (100.0 * static_cast<double>(undelayed)) / static_cast<double>(shots);
+  return row;
+}
+
+static void printRow(const char *mode, const DitherRow &row)
+{
+  printf("  %-24s | %5.1f ms | %5.1f %%  | %5.1f %%            | %5.1f %%\n", mode, row.period_ms,
+         row.ghost_pct, row.accepted_pct, row.valid_pct);
+}
+
+static void printIrqRow(const char *mode, const DitherRow &row)
+{
+  printf("  %-24s | %5.1f ms | %5.1f %%  | %5.1f %%            | %5.1f %% | %5.1f %%\n", mode, row.period_ms,
+         row.ghost_pct, row.accepted_pct, row.valid_pct, row.undelayed_pct);
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  host_micros_step = 0UL;
+
+  printf("4 sensors, wall at 1 m, neighbours over 1.1 m, 60 ms min cycle, 300 us tolerance\n\n");
+  printf("  Mode                     | Period   | Ghosts   | Accepted (> 10 cm) | Valid\n");
+  printf("  -------------------------+----------+----------+--------------------+--------\n");
+  const DitherRow fixed = runLayout(false, 0UL, HCSR04_DITHER_TOL_US);
+  printRow("Fixed cycle", fixed);
+  printRow("Fixed cycle + check", runLayout(true, 0UL, HCSR04_DITHER_TOL_US));
+  printRow("Jitter 0..4 ms + check", runLayout(true, 4000UL, HCSR04_DITHER_TOL_US));
+  const DitherRow dflt = runLayout(true, HCSR04_DITHER_MAX_US, HCSR04_DITHER_TOL_US);
+  printRow("Jitter 0..8 ms + check", dflt);
+  printRow("Jitter 0..20 ms + check", runLayout(true, 20000UL, HCSR04_DITHER_TOL_US));
+
+  printf("\nHCSR04_Interrupt-style sensors (read triggers and pops), adaptive cycle with a %lu ms guard,\n"
+         "loop() polling every %lu ms\n\n", IRQ_GUARD_US / 1000UL, IRQ_POLL_US / 1000UL);
+  printf("  Mode                     | Period   | Ghosts   | Accepted (> 10 cm) | Valid   | Undelayed shots\n");
+  printf("  -------------------------+----------+----------+--------------------+---------+----------------\n");
+  const DitherRow irq_fixed = runLayout(false, 0UL, HCSR04_DITHER_TOL_US, true);
+  printIrqRow("Fixed cycle", irq_fixed);
+  const DitherRow irq_dflt = runLayout(true, HCSR04_DITHER_MAX_US, HCSR04_DITHER_TOL_US, true);
+  printIrqRow("Jitter 0..8 ms + check", irq_dflt);
+
+  const bool ok = ((dflt.accepted_pct * 10.0) <= fixed.accepted_pct) && (irq_dflt.undelayed_pct == 0.0);
+  printf("\n%s\n", ok ? "PASS: default jitter cuts accepted ghosts tenfold, every shot delayed" : "FAIL");
+  return ok ? 0 : 1;
+}
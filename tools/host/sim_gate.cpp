@@ -0,0 +1,277 @@
+/**
+ * @file sim_gate.cpp
+ * @brief HCSR04_Gate: short spikes never pass, real steps re-acquired after N shots, any hold.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * A FeedSensor hands the gate scripted readRawUs() results (max jump 200 mm).
+ * 1) Spikes and steps: a target at 1000 mm jumps to 2500 mm for L shots, then comes
+ *    back; for re-acquisition N = 2, 3 (default), 5 and Hold-Last-Value 0, 2, 5, every
+ *    L = 1..N - 1 must stay rejected (HELD while the hold lasts, INVALID after), and a
+ *    step that stays must turn GOOD on exactly its N-th shot.
+ * 2) Random stream: 20000 shots per N (xorshift32, fixed seed, random hold 0..4): a
+ *    target wandering by up to +-30 mm per shot, 1 shot in 10 a timeout, and spikes of
+ *    1..N - 1 shots (500..1500 mm away, within 20 mm of each other, the worst case for
+ *    the consistency rule), each followed by a target shot. Every target shot must be
+ *    GOOD, no spike shot may be, and a rejected shot must be HELD exactly while
+ *    stale <= hold.
+ *
+ * Exit status 1 on any spike shot reported GOOD, a target shot not GOOD, a wrong
+ * HELD/INVALID quality, or a step not re-acquired on its N-th shot.
+ */
+
+#include <stdio.h>
+#include "hcsr04_gate.hpp"
+
+/* ================================== Model ================================== */
+
+static const uint16_t MAX_JUMP_MM = 200U;
+static const unsigned long RANDOM_SHOTS = 20000UL;
+
+static uint32_t s_rng = 0x2F6B1A9DUL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+/* Echo time of a distance at the default sound speed (0.1715 mm/us). */
+static unsigned long mmToUs(unsigned long mm)
+{
+  return (mm * 10000UL + 857UL) / 1715UL;
+}
+
+/* readRawUs() returns whatever the test sets next. */
+class FeedSensor : public IHCSR04
+{
+public:
+  FeedSensor(void) :
+    IHCSR04(9U, 8U),
+    m_status(HCSR04_OK),
+    m_echo_us(0UL)
+  {
+  }
+
+  void next(HCSR04_Status status, unsigned long echo_us)
+  {
+    m_status = status;
+    m_echo_us = echo_us;
+  }
+
+  HCSR04_Status begin(void) { return HCSR04_OK; }
+
+  HCSR04_Status read(float &out_cm)
+  {
+    out_cm = 0.0F;
+    return HCSR04_ERR_NOT_READY;
+  }
+
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    if (m_status == HCSR04_OK)
+    {
+      out_echo_us = m_echo_us;
+    }
+    return m_status;
+  }
+
+private:
+  HCSR04_Status m_status;
+  unsigned long m_echo_us;
+};
+
+struct GateCheck
+{
+  unsigned long spikes_passed;  /* spike shots reported GOOD */
+  unsigned long target_lost;    /* target shots not GOOD */
+  unsigned long quality_err;    /* rejected shot HELD/INVALID against stale vs hold */
+  unsigned long shots;
+};
+
+static HCSR04_GatedReading shoot(HCSR04_Gate &gate, FeedSensor &feed, HCSR04_Status st, unsigned long mm)
+{
+  HCSR04_GatedReading r = { 0U, 0UL, HCSR04_QUALITY_INVALID, 0U, HCSR04_ERR_NOT_READY };
+  feed.next(st, mmToUs(mm));
+  (void)gate.readQualified(r);
+  return r;
+}
+
+static void checkRejected(const HCSR04_GatedReading &r, uint8_t hold, GateCheck &res)
+{
+  const HCSR04_Quality expect = (r.stale <= hold) ? HCSR04_QUALITY_HELD : HCSR04_QUALITY_INVALID;
+  res.quality_err += (r.quality != expect) ? 1UL : 0UL;
+}
+
+/* Spike of length L (0: none), then one shot back; returns spike shots that passed. */
+static unsigned spikeRun(uint8_t reacquire, uint8_t hold, uint8_t len, GateCheck &res)
+{
+  FeedSensor feed;
+  HCSR04_Gate gate(feed);
+  (void)gate.begin();
+  gate.setMaxJumpMm(MAX_JUMP_MM);
+  gate.setHoldLast(hold);
+  (void)gate.setReacquire(reacquire);
+
+  for (uint8_t i = 0U; i < 5U; i++)
+  {
+    (void)shoot(gate, feed, HCSR04_OK, 1000UL);
+  }
+  unsigned passed = 0U;
+  for (uint8_t i = 0U; i < len; i++)
+  {
+    const HCSR04_GatedReading r = shoot(gate, feed, HCSR04_OK, 2500UL + i);
+    if (r.quality == HCSR04_QUALITY_GOOD)
+    {
+      passed++;
+    }
+    else
+    {
+      checkRejected(r, hold, res);
+    }
+  }
+  const HCSR04_GatedReading back = shoot(gate, feed, HCSR04_OK, 1000UL);
+  res.target_lost += (back.quality != HCSR04_QUALITY_GOOD) ? 1UL : 0UL;
+  return passed;
+}
+
+/* Shots of a lasting step until GOOD (0: not within 20). */
+static unsigned stepRun(uint8_t reacquire, uint8_t hold, GateCheck &res)
+{
+  FeedSensor feed;
+  HCSR04_Gate gate(feed);
+  (void)gate.begin();
+  gate.setMaxJumpMm(MAX_JUMP_MM);
+  gate.setHoldLast(hold);
+  (void)gate.setReacquire(reacquire);
+
+  for (uint8_t i = 0U; i < 5U; i++)
+  {
+    (void)shoot(gate, feed, HCSR04_OK, 1000UL);
+  }
+  unsigned delay = 0U;
+  for (unsigned i = 1U; (i <= 20U) && (delay == 0U); i++)
+  {
+    const HCSR04_GatedReading r = shoot(gate, feed, HCSR04_OK, 2500UL + (3U * i));
+    if (r.quality == HCSR04_QUALITY_GOOD)
+    {
+      delay = i;
+    }
+    else
+    {
+      checkRejected(r, hold, res);
+    }
+  }
+  return delay;
+}
+
+static GateCheck randomRun(uint8_t reacquire)
+{
+  FeedSensor feed;
+  HCSR04_Gate gate(feed);
+  (void)gate.begin();
+  gate.setMaxJumpMm(MAX_JUMP_MM);
+  (void)gate.setReacquire(reacquire);
+
+  GateCheck res = { 0UL, 0UL, 0UL, 0UL };
+  long target_mm = 1500L;
+  uint8_t hold = 0U;
+  bool after_spike = false;
+  while (res.shots < RANDOM_SHOTS)
+  {
+    if ((nextRandom() % 50UL) == 0UL)
+    {
+      hold = static_cast<uint8_t>(nextRandom() % 5UL);
+      gate.setHoldLast(hold);
+    }
+
+    /* A spike is always followed by a target shot (back to back they would be a step). */
+    if (!after_spike && ((nextRandom() % 8UL) == 0UL))
+    {
+      after_spike = true;
+      /* Spike of 1..N - 1 shots, consistent with itself. */
+      const uint8_t len = static_cast<uint8_t>(1UL + (nextRandom() % (reacquire - 1U)));
+      const long off = 500L + static_cast<long>(nextRandom() % 1001UL);
+      const long spike_mm = ((nextRandom() % 2UL) == 0UL) ? (target_mm + off) : (target_mm - off);
+      for (uint8_t i = 0U; (i < len) && (spike_mm > 20L); i++)
+      {
+        const long mm = (spike_mm + static_cast<long>(nextRandom() % 21UL)) - 10L;
+        const HCSR04_GatedReading r = shoot(gate, feed, HCSR04_OK, static_cast<unsigned long>(mm));
+        res.shots++;
+        if (r.quality == HCSR04_QUALITY_GOOD)
+        {
+          res.spikes_passed++;
+        }
+        else
+        {
+          checkRejected(r, hold, res);
+        }
+      }
+    }
+    else if ((nextRandom() % 10UL) == 0UL)
+    {
+      const HCSR04_GatedReading r = shoot(gate, feed, HCSR04_ERR_TIMEOUT_ECHO_END, 0UL);
+      res.shots++;
+      checkRejected(r, hold, res);
+    }
+    else
+    {
+      /* The target moves between its own shots only: within max jump of the last GOOD. */
+      target_mm += static_cast<long>(nextRandom() % 61UL) - 30L;
+      target_mm = (target_mm < 600L) ? 600L : ((target_mm > 2400L) ? 2400L : target_mm);
+      after_spike = false;
+      const HCSR04_GatedReading r = shoot(gate, feed, HCSR04_OK, static_cast<unsigned long>(target_mm));
+      res.shots++;
+      res.target_lost += (r.quality != HCSR04_QUALITY_GOOD) ? 1UL : 0UL;
+    }
+  }
+  return res;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const uint8_t REACQUIRE[] = { 2U, 3U, 5U };
+  static const uint8_t HOLDS[] = { 0U, 2U, 5U };
+  bool ok = true;
+
+  printf("1) 1000 mm -> 2500 mm for L shots, max jump %u mm\n\n", MAX_JUMP_MM);
+  printf("  Reacquire | Hold | Spike shots passed (L = 1..N-1) | Step GOOD on shot | Quality errors\n");
+  printf("  ----------+------+---------------------------------+-------------------+---------------\n");
+  for (uint8_t n = 0U; n < 3U; n++)
+  {
+    for (uint8_t h = 0U; h < 3U; h++)
+    {
+      GateCheck res = { 0UL, 0UL, 0UL, 0UL };
+      unsigned passed = 0U;
+      for (uint8_t len = 1U; len < REACQUIRE[n]; len++)
+      {
+        passed += spikeRun(REACQUIRE[n], HOLDS[h], len, res);
+      }
+      const unsigned delay = stepRun(REACQUIRE[n], HOLDS[h], res);
+      printf("  %5u%-4s | %4u | %31u | %2u (expected %u)   | %lu\n", REACQUIRE[n],
+             (REACQUIRE[n] == HCSR04_GATE_REACQUIRE) ? " (d)" : "", HOLDS[h], passed, delay, REACQUIRE[n],
+             res.quality_err + res.target_lost);
+      ok = ok && (passed == 0U) && (delay == REACQUIRE[n]) && (res.quality_err == 0UL) && (res.target_lost == 0UL);
+    }
+  }
+
+  printf("\n2) Random stream, %lu shots per row: target +-30 mm/shot, 1 in 10 timeouts, spikes of 1..N-1 shots\n\n",
+         RANDOM_SHOTS);
+  printf("  Reacquire | Spike shots passed | Target shots not GOOD | Quality errors\n");
+  printf("  ----------+--------------------+-----------------------+---------------\n");
+  for (uint8_t n = 0U; n < 3U; n++)
+  {
+    const GateCheck res = randomRun(REACQUIRE[n]);
+    printf("  %5u     | %18lu | %21lu | %lu\n", REACQUIRE[n], res.spikes_passed, res.target_lost, res.quality_err);
+    ok = ok && (res.spikes_passed == 0UL) && (res.target_lost == 0UL) && (res.quality_err == 0UL);
+  }
+
+  printf("\n%s\n", ok ? "PASS: spikes shorter than N rejected, steps GOOD on shot N whatever the hold" : "FAIL");
+  return ok ? 0 : 1;
+}
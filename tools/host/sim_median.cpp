@@ -0,0 +1,235 @@
+/**
+ * @file sim_median.cpp
+ * @brief HCSR04_Median<N> against a brute-force sorted window, plus its step/spike claims.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * A FeedSensor hands the decorator a scripted stream of readRawUs() results. Every
+ * output of HCSR04_Median<N> is compared with the median of the last min(count, N)
+ * HCSR04_OK samples, sorted from scratch (mean of the two middle ones, rounded up,
+ * while an even count fills). Streams (xorshift32, fixed seed, 200000 reads per
+ * window length N = 3, 5, 9, 15, 63):
+ * - narrow: values 0..7, so the window is full of duplicates;
+ * - wide: 0..70000, echoes above 65535 us saturate to 0xFFFF;
+ * - 1 read in 8 is a timeout (must pass through and stay out of the window), 1 in 5000
+ *   a reset().
+ * Step and spike: after a full window at 1000 us, a step to 3000 us must show on the
+ * (N + 1) / 2-th new sample, and a single 9000 us spike must never show.
+ *
+ * Exit status 1 on any mismatch.
+ */
+
+#include <stdio.h>
+#include "hcsr04_median.hpp"
+
+/* ================================== Model ================================== */
+
+static const unsigned long READS = 200000UL;
+
+static uint32_t s_rng = 0x9E3779B9UL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+/* readRawUs() returns whatever the test sets next. */
+class FeedSensor : public IHCSR04
+{
+public:
+  FeedSensor(void) :
+    IHCSR04(9U, 8U),
+    m_status(HCSR04_OK),
+    m_echo_us(0UL)
+  {
+  }
+
+  void next(HCSR04_Status status, unsigned long echo_us)
+  {
+    m_status = status;
+    m_echo_us = echo_us;
+  }
+
+  HCSR04_Status begin(void) { return HCSR04_OK; }
+
+  HCSR04_Status read(float &out_cm)
+  {
+    out_cm = 0.0F;
+    return HCSR04_ERR_NOT_READY;
+  }
+
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    if (m_status == HCSR04_OK)
+    {
+      out_echo_us = m_echo_us;
+    }
+    return m_status;
+  }
+
+private:
+  HCSR04_Status m_status;
+  unsigned long m_echo_us;
+};
+
+/* Median of the last count samples of hist (newest last), sorted from scratch. */
+static unsigned long bruteMedian(const uint16_t *hist, uint8_t count)
+{
+  uint16_t sorted[64];
+  for (uint8_t i = 0U; i < count; i++)
+  {
+    sorted[i] = hist[i];
+  }
+  for (uint8_t i = 1U; i < count; i++)
+  {
+    for (uint8_t j = i; (j > 0U) && (sorted[j - 1U] > sorted[j]); j--)
+    {
+      const uint16_t t = sorted[j];
+      sorted[j] = sorted[j - 1U];
+      sorted[j - 1U] = t;
+    }
+  }
+  const uint8_t mid = static_cast<uint8_t>(count / 2U);
+  unsigned long value = sorted[mid];
+  if ((count % 2U) == 0U)
+  {
+    value = (value + sorted[mid - 1U] + 1UL) / 2UL;
+  }
+  return value;
+}
+
+/* Random stream cross-check; returns the number of mismatches. */
+template <uint8_t N>
+static unsigned long crossCheck(unsigned long max_us)
+{
+  FeedSensor feed;
+  HCSR04_Median<N> median(feed);
+  (void)median.begin();
+
+  uint16_t hist[N];
+  uint8_t count = 0U;
+  unsigned long mismatches = 0UL;
+
+  for (unsigned long k = 0UL; k < READS; k++)
+  {
+    const uint32_t r = nextRandom();
+    if ((r % 5000UL) == 0UL)
+    {
+      median.reset();
+      count = 0U;
+    }
+
+    const bool timeout = ((r % 8UL) == 1UL);
+    const unsigned long echo_us = nextRandom() % (max_us + 1UL);
+    feed.next(timeout ? HCSR04_ERR_TIMEOUT_ECHO_START : HCSR04_OK, echo_us);
+
+    unsigned long out_us = 0xDEADUL;
+    const HCSR04_Status st = median.readRawUs(out_us);
+    if (timeout)
+    {
+      if ((st != HCSR04_ERR_TIMEOUT_ECHO_START) || (out_us != 0xDEADUL))
+      {
+        mismatches++;
+      }
+    }
+    else
+    {
+      const uint16_t sample = (echo_us > 0xFFFFUL) ? 0xFFFFU : static_cast<uint16_t>(echo_us);
+      if (count < N)
+      {
+        hist[count] = sample;
+        count++;
+      }
+      else
+      {
+        for (uint8_t i = 1U; i < N; i++)
+        {
+          hist[i - 1U] = hist[i];
+        }
+        hist[N - 1U] = sample;
+      }
+      if ((st != HCSR04_OK) || (out_us != bruteMedian(hist, count)) || (median.getCount() != count))
+      {
+        if (mismatches < 3UL)
+        {
+          printf("  N=%u read %lu: got %lu, expected %lu\n", N, k, out_us, bruteMedian(hist, count));
+        }
+        mismatches++;
+      }
+    }
+  }
+  return mismatches;
+}
+
+/* Samples of the new level until the output follows a step (0: never within 2N). */
+template <uint8_t N>
+static unsigned stepDelay(bool &spike_seen)
+{
+  FeedSensor feed;
+  HCSR04_Median<N> median(feed);
+  (void)median.begin();
+  unsigned long out_us = 0UL;
+
+  for (uint8_t i = 0U; i < N; i++)
+  {
+    feed.next(HCSR04_OK, 1000UL);
+    (void)median.readRawUs(out_us);
+  }
+  feed.next(HCSR04_OK, 9000UL);
+  (void)median.readRawUs(out_us);
+  spike_seen = (out_us != 1000UL);
+  for (uint8_t i = 0U; i < N; i++)
+  {
+    feed.next(HCSR04_OK, 1000UL);
+    (void)median.readRawUs(out_us);
+    spike_seen = spike_seen || (out_us != 1000UL);
+  }
+
+  unsigned delay = 0U;
+  for (unsigned i = 1U; (i <= (2U * N)) && (delay == 0U); i++)
+  {
+    feed.next(HCSR04_OK, 3000UL);
+    (void)median.readRawUs(out_us);
+    if (out_us == 3000UL)
+    {
+      delay = i;
+    }
+  }
+  return delay;
+}
+
+template <uint8_t N>
+static bool runWindow(void)
+{
+  const unsigned long narrow = crossCheck<N>(7UL);
+  const unsigned long wide = crossCheck<N>(70000UL);
+  bool spike_seen = false;
+  const unsigned delay = stepDelay<N>(spike_seen);
+  printf("  %2u | %10lu | %10lu  | %2u (expected %2u)  | %s\n", N, narrow, wide, delay, (N + 1U) / 2U,
+         spike_seen ? "passed" : "rejected");
+  return (narrow == 0UL) && (wide == 0UL) && (delay == ((N + 1U) / 2U)) && !spike_seen;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  printf("HCSR04_Median<N> vs sorted window, %lu reads per stream, 1 in 8 a timeout\n\n", READS);
+  printf("   N | Mismatches | Mismatches  | Step shows after  | Single spike\n");
+  printf("     | 0..7 us    | 0..70000 us | (samples)         |\n");
+  printf("  ---+------------+-------------+-------------------+-------------\n");
+  bool ok = true;
+  ok = runWindow<3>() && ok;
+  ok = runWindow<5>() && ok;
+  ok = runWindow<9>() && ok;
+  ok = runWindow<15>() && ok;
+  ok = runWindow<63>() && ok;
+
+  printf("\n%s\n", ok ? "PASS: median exact, steps after (N + 1) / 2 samples, spikes rejected" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file sim_seqlock.cpp
+ * @brief Edge-injection stress test of HCSR04_SeqLock against direct 32-bit reads.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * Model of the AVR hazard: a 32-bit load is four 1-byte loads, and an ISR may run before
+ * any of them. Every byte copy below goes through a hook that, with probability p,
+ * first runs the "edge ISR": it publishes the next rise/fall pair, both as plain
+ * volatile words (the old HCSR04_Interrupt path) and through HCSR04_SeqLock.
+ *
+ * A reader result is torn when it matches no published pair. The direct reader copies
+ * rise then fall byte by byte (8 injection points). The seqlock reader is the real
+ * HCSR04_SeqLock<T>::read(); T copies itself byte by byte through the same hook.
+ *
+ * Exit status 1 if the seqlock ever returns a torn pair, or if the direct reader is
+ * never torn under injection (the harness would then prove nothing).
+ */
+
+#include <stdio.h>
+#include "hcsr04_seqlock.hpp"
+
+/* ============================== Injection model ============================ */
+
+static uint32_t s_rng = 0x9E3779B9UL;
+static uint32_t s_inject_threshold = 0UL;   /* p * 2^32 */
+static bool s_in_isr = false;
+static unsigned long s_isr_runs = 0UL;
+
+static uint32_t nextRandom(void)
+{
+  /* xorshift32, as in HCSR04_Dither. */
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+static void maybeRunIsr(void);
+
+/* Payload whose copy is four byte loads per word, each one an injection point. */
+struct HookedPair
+{
+  uint8_t bytes[8];   /* rise_us (LE), fall_us (LE) */
+
+  HookedPair &operator=(const HookedPair &other)
+  {
+    for (uint8_t i = 0U; i < 8U; i++)
+    {
+      maybeRunIsr();
+      bytes[i] = other.bytes[i];
+    }
+    maybeRunIsr();
+    return *this;
+  }
+};
+
+static void packPair(HookedPair &p, uint32_t rise_us, uint32_t fall_us)
+{
+  for (uint8_t i = 0U; i < 4U; i++)
+  {
+    p.bytes[i] = static_cast<uint8_t>(rise_us >> (8U * i));
+    p.bytes[4U + i] = static_cast<uint8_t>(fall_us >> (8U * i));
+  }
+}
+
+static uint32_t word(const HookedPair &p, uint8_t offset)
+{
+  uint32_t v = 0UL;
+  for (uint8_t i = 0U; i < 4U; i++)
+  {
+    v |= static_cast<uint32_t>(p.bytes[offset + i]) << (8U * i);
+  }
+  return v;
+}
+
+/* ============================== Edge publisher ============================= */
+
+static volatile uint8_t s_direct[8];           /* old s_rise_us / s_fall_us, byte view */
+static HCSR04_SeqLock<HookedPair> s_lock;
+/* 32-bit like micros() on the AVR (unsigned long is wider on most hosts). */
+static uint32_t s_rise_us = 0xFFFF0000UL;      /* crosses byte (and wrap) boundaries */
+static uint32_t s_fall_us = 0UL;
+static uint32_t s_prev_rise_us = 0UL;
+static uint32_t s_prev_fall_us = 0UL;
+
+static void publishNext(void)
+{
+  s_prev_rise_us = s_rise_us;
+  s_prev_fall_us = s_fall_us;
+  /* ~60 ms cycle, echo width 0..23 ms: every byte of both words keeps changing. */
+  s_rise_us += 60000UL + (nextRandom() % 2000UL);
+  s_fall_us = s_rise_us + 150UL + (nextRandom() % 23000UL);
+
+  HookedPair p;
+  packPair(p, s_rise_us, s_fall_us);
+  for (uint8_t i = 0U; i < 8U; i++)
+  {
+    s_direct[i] = p.bytes[i];
+  }
+  s_lock.write(p);
+}
+
+static void maybeRunIsr(void)
+{
+  if ((s_in_isr == false) && (nextRandom() < s_inject_threshold))
+  {
+    s_in_isr = true;
+    publishNext();
+    s_isr_runs++;
+    s_in_isr = false;
+  }
+}
+
+static bool isPublished(uint32_t rise_us, uint32_t fall_us)
+{
+  return ((rise_us == s_rise_us) && (fall_us == s_fall_us)) ||
+         ((rise_us == s_prev_rise_us) && (fall_us == s_prev_fall_us));
+}
+
+/* ================================ Readers ================================== */
+
+static bool readDirect(void)
+{
+  /* Two volatile 32-bit loads, byte by byte as avr-gcc emits them. */
+  HookedPair p;
+  for (uint8_t i = 0U; i < 8U; i++)
+  {
+    maybeRunIsr();
+    p.bytes[i] = s_direct[i];
+  }
+  return isPublished(word(p, 0U), word(p, 4U));
+}
+
+static bool readSeqLock(void)
+{
+  HookedPair p;
+  (void)s_lock.read(p);
+  return isPublished(word(p, 0U), word(p, 4U));
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const double rates[] = { 0.0001, 0.001, 0.01, 0.05, 0.2 };
+  static const unsigned long READS = 1000000UL;
+  int rc = 0;
+
+  s_in_isr = true;
+  publishNext();
+  publishNext();
+  s_in_isr = false;
+
+  printf("HCSR04_SeqLock edge-injection stress, %lu reads per row\n\n", READS);
+  printf("  ISR chance per   | Torn, direct    | Torn, seqlock | ISR runs per\n");
+  printf("  byte load        | 32-bit reads    |               | seqlock read\n");
+  printf("  -----------------+-----------------+---------------+-------------\n");
+
+  for (size_t r = 0U; r < (sizeof(rates) / sizeof(rates[0])); r++)
+  {
+    s_inject_threshold = static_cast<uint32_t>(rates[r] * 4294967295.0);
+
+    unsigned long torn_direct = 0UL;
+    for (unsigned long k = 0UL; k < READS; k++)
+    {
+      if (readDirect() == false)
+      {
+        torn_direct++;
+      }
+    }
+
+    unsigned long torn_lock = 0UL;
+    s_isr_runs = 0UL;
+    for (unsigned long k = 0UL; k < READS; k++)
+    {
+      if (readSeqLock() == false)
+      {
+        torn_lock++;
+      }
+    }
+
+    printf("  %-16g | %8.4f %%      | %8.4f %%    | %.3f\n", rates[r],
+           (100.0 * static_cast<double>(torn_direct)) / static_cast<double>(READS),
+           (100.0 * static_cast<double>(torn_lock)) / static_cast<double>(READS),
+           static_cast<double>(s_isr_runs) / static_cast<double>(READS));
+
+    if ((torn_lock != 0UL) || (torn_direct == 0UL))
+    {
+      rc = 1;
+    }
+  }
+
+  printf("\n%s\n", (rc == 0) ? "PASS: no torn seqlock snapshot" : "FAIL");
+  return rc;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file sim_shared_trig.cpp
+ * @brief HCSR04_SharedTrig with six HostSr04 modules on A0..A5: per-line results, group window.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * One TRIG (D7) fires six lines sampled as PORTC. Every module is a HostSr04 driven from
+ * micros() (4 us per call, about one port sample); line 1 has no module (ECHO never
+ * rises) and line 3 has no reflector (ECHO stays high 38 ms, past the window). Ranges
+ * are drawn per shot (xorshift32, fixed seed), line 5 always at line 2's range so both
+ * edges land in the same port sample. 300 shots per scene:
+ * - mixed: lines 0, 2, 4, 5 measured, 1 timeout-start, 3 timeout-end;
+ * - all measured: a module on every line, the group must end at the farthest echo;
+ * - none measured: reflectors off, readRawUs() must return line 0's status;
+ * - max range 2 m: lines 0 and 4 beyond it (out of range), the shorter window and min
+ *   cycle; trigger() must wait while line 3 is still high.
+ * Expected per line: timeout-start without a module, OK when the model's pulse ends
+ * inside the window, otherwise timeout-end (out of range with setMaxRangeCm()).
+ *
+ * Exit status 1 on any per-line status mismatch, an echo time more than 8 us from the
+ * model, readRawUs() not equal to the nearest OK line (or line 0's status when none),
+ * a group that does not close at the farthest echo / at the window, or if, with the
+ * 2 m range, the min cycle never elapses while line 3 is still high ("Busy" counts
+ * the refusals after the min cycle).
+ */
+
+#include <stdio.h>
+#include "hcsr04_shared_trig.hpp"
+#include "host_sr04.hpp"
+
+/* ================================== Model ================================== */
+
+static const uint8_t LINES = 6U;
+static const uint8_t TRIG_PIN = 7U;
+static const uint8_t ECHO_PINS[LINES] = { 14U, 15U, 16U, 17U, 18U, 19U };  /* A0..A5 */
+static const uint8_t NO_MODULE_LINE = 1U;
+static const uint8_t SILENT_LINE = 3U;
+static const unsigned long SHOTS = 300UL;
+static const unsigned long STEP_US = 4UL;
+static const unsigned long ECHO_TOL_US = 2UL * STEP_US;
+
+static HostSr04 *s_modules[LINES];
+static uint32_t s_rng = 0x5EED1234UL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+static void serviceModules(void)
+{
+  for (uint8_t i = 0U; i < LINES; i++)
+  {
+    if (s_modules[i] != 0)
+    {
+      (void)s_modules[i]->service();
+    }
+  }
+}
+
+static unsigned long roundTripUs(unsigned long cm)
+{
+  /* 343 m/s: 58.3 us per cm of range. */
+  return (cm * 20000UL + 171UL) / 343UL;
+}
+
+enum Scene
+{
+  SCENE_MIXED,
+  SCENE_ALL,
+  SCENE_NONE,
+  SCENE_MAX_RANGE
+};
+
+struct SceneRow
+{
+  unsigned long status_err;   /* per-line status differs from the model */
+  unsigned long max_echo_err; /* us, OK lines */
+  unsigned long nearest_err;  /* readRawUs() vs nearest OK line (or line 0's status) */
+  unsigned long window_err;   /* group closed too early or too late */
+  unsigned long min_group_us; /* trigger to end of readRawUs() */
+  unsigned long max_group_us;
+  unsigned long ok_lines;
+  unsigned long busy;         /* readRawUs() refused (line 3 still high) */
+};
+
+static SceneRow runScene(Scene scene)
+{
+  HCSR04_SharedTrig group(TRIG_PIN, ECHO_PINS, LINES);
+  HostSr04 m0(group, ECHO_PINS[0]);
+  HostSr04 m1(group, ECHO_PINS[1]);
+  HostSr04 m2(group, ECHO_PINS[2]);
+  HostSr04 m3(group, ECHO_PINS[3]);
+  HostSr04 m4(group, ECHO_PINS[4]);
+  HostSr04 m5(group, ECHO_PINS[5]);
+  HostSr04 *modules[LINES] = { &m0, &m1, &m2, &m3, &m4, &m5 };
+  if (scene != SCENE_ALL)
+  {
+    modules[NO_MODULE_LINE] = 0;  /* unplugged: ECHO stays low */
+    hostSetPin(ECHO_PINS[NO_MODULE_LINE], LOW);
+  }
+  for (uint8_t i = 0U; i < LINES; i++)
+  {
+    s_modules[i] = modules[i];
+  }
+  host_on_micros = serviceModules;
+  host_micros_step = STEP_US;
+  host_now_us += 1000000UL;
+  serviceModules();
+
+  (void)group.begin();
+  if (scene == SCENE_MAX_RANGE)
+  {
+    (void)group.setMaxRangeCm(200U);
+  }
+
+  SceneRow row = { 0UL, 0UL, 0UL, 0UL, 0xFFFFFFFFUL, 0UL, 0UL, 0UL };
+  for (unsigned long shot = 0UL; shot < SHOTS; shot++)
+  {
+    /* Ranges for this shot; line 5 mirrors line 2 (same-sample edges). */
+    unsigned long range_cm[LINES];
+    for (uint8_t i = 0U; i < LINES; i++)
+    {
+      range_cm[i] = 10UL + (nextRandom() % 340UL);
+    }
+    if (scene == SCENE_MAX_RANGE)
+    {
+      range_cm[0] = 250UL + (nextRandom() % 100UL);
+      range_cm[4] = 230UL + (nextRandom() % 100UL);
+      range_cm[2] = 10UL + (nextRandom() % 170UL);
+    }
+    range_cm[5] = range_cm[2];
+    for (uint8_t i = 0U; i < LINES; i++)
+    {
+      if (modules[i] != 0)
+      {
+        modules[i]->setReflector(0U, roundTripUs(range_cm[i]));
+        modules[i]->setMask(((scene == SCENE_NONE) || ((scene != SCENE_ALL) && (i == SILENT_LINE))) ? 0x00U : 0x01U);
+      }
+    }
+
+    /* Fire as soon as the driver accepts (min cycle, no ECHO line high). */
+    unsigned long raw_us = 0UL;
+    unsigned long start_us = host_now_us;
+    HCSR04_Status raw = group.readRawUs(raw_us);
+    while (raw == HCSR04_ERR_BUSY)
+    {
+      row.busy += ((host_now_us - group.getLastShotTimestampUs()) >= group.getMinCycleUs()) ? 1UL : 0UL;
+      host_now_us += 500UL;
+      serviceModules();
+      start_us = host_now_us;
+      raw = group.readRawUs(raw_us);
+    }
+    const unsigned long group_us = host_now_us - start_us;
+    row.min_group_us = (group_us < row.min_group_us) ? group_us : row.min_group_us;
+    row.max_group_us = (group_us > row.max_group_us) ? group_us : row.max_group_us;
+
+    /* Per line, against the model. */
+    const unsigned long window_us = group.getTimeoutUs();
+    bool any_open = false;
+    bool any_ok = false;
+    unsigned long nearest_us = 0xFFFFFFFFUL;
+    unsigned long farthest_end_us = 0UL;
+    HCSR04_Status line0 = HCSR04_ERR_NOT_READY;
+    for (uint8_t i = 0U; i < LINES; i++)
+    {
+      HCSR04_Status expect = HCSR04_ERR_TIMEOUT_ECHO_START;
+      unsigned long pulse_us = 0UL;
+      if (modules[i] != 0)
+      {
+        pulse_us = modules[i]->lastPulseUs();
+        if ((HOST_SR04_LATENCY_US + pulse_us) < window_us)
+        {
+          expect = HCSR04_OK;
+        }
+        else
+        {
+          expect = (scene == SCENE_MAX_RANGE) ? HCSR04_ERR_OUT_OF_RANGE : HCSR04_ERR_TIMEOUT_ECHO_END;
+        }
+      }
+      unsigned long echo_us = 0UL;
+      const HCSR04_Status got = group.getEchoUs(i, echo_us);
+      line0 = (i == 0U) ? got : line0;
+      if (got != expect)
+      {
+        row.status_err++;
+      }
+      if (got == HCSR04_OK)
+      {
+        const unsigned long err = (echo_us > pulse_us) ? (echo_us - pulse_us) : (pulse_us - echo_us);
+        row.max_echo_err = (err > row.max_echo_err) ? err : row.max_echo_err;
+        nearest_us = (echo_us < nearest_us) ? echo_us : nearest_us;
+        farthest_end_us = ((HOST_SR04_LATENCY_US + pulse_us) > farthest_end_us) ?
+                          (HOST_SR04_LATENCY_US + pulse_us) : farthest_end_us;
+        any_ok = true;
+        row.ok_lines++;
+      }
+      else
+      {
+        any_open = true;
+      }
+    }
+
+    if (any_ok ? ((raw != HCSR04_OK) || (raw_us != nearest_us)) : (raw != line0))
+    {
+      row.nearest_err++;
+    }
+    /* One window for the whole group: closes at the window if a line is open, else
+       right after the farthest falling edge (allowance: TRIG pulse, the micros() calls
+       of trigger() and one sample). */
+    const unsigned long close_us = any_open ? window_us : farthest_end_us;
+    if ((group_us < close_us) || (group_us > (close_us + HCSR04_TRIG_PULSE_US + (5UL * STEP_US))))
+    {
+      row.window_err++;
+    }
+  }
+
+  host_on_micros = 0;
+  for (uint8_t i = 0U; i < LINES; i++)
+  {
+    s_modules[i] = 0;
+  }
+  return row;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const struct
+  {
+    const char *label;
+    Scene       scene;
+  } CASES[] = {
+    { "mixed (0 2 4 5 / 1 / 3)", SCENE_MIXED },
+    { "all measured",            SCENE_ALL },
+    { "none measured",           SCENE_NONE },
+    { "max range 2 m",           SCENE_MAX_RANGE },
+  };
+
+  printf("HCSR04_SharedTrig, 6 lines on PORTC, %lu shots per scene, %lu us per sample\n\n", SHOTS, STEP_US);
+  printf("  Scene                    | OK lines | Status err | Max echo err | Nearest err | Group time (us) | Window err | Busy\n");
+  printf("  -------------------------+----------+------------+--------------+-------------+-----------------+------------+-----\n");
+  bool ok = true;
+  for (size_t c = 0U; c < (sizeof(CASES) / sizeof(CASES[0])); c++)
+  {
+    const SceneRow row = runScene(CASES[c].scene);
+    printf("  %-24s | %8lu | %10lu | %9lu us | %11lu | %6lu..%-6lu  | %10lu | %lu\n", CASES[c].label, row.ok_lines,
+           row.status_err, row.max_echo_err, row.nearest_err, row.min_group_us, row.max_group_us, row.window_err,
+           row.busy);
+    if ((row.status_err != 0UL) || (row.max_echo_err > ECHO_TOL_US) || (row.nearest_err != 0UL) ||
+        (row.window_err != 0UL) || ((CASES[c].scene == SCENE_MAX_RANGE) && (row.busy == 0UL)))
+    {
+      ok = false;
+    }
+  }
+
+  printf("\n%s\n", ok ? "PASS: per-line results, nearest echo and group window as modeled" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+/**
+ * @file sim_stats.cpp
+ * @brief HCSR04_Stats<N> against the window recomputed from scratch, and a long drift run.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * A FeedSensor hands the decorator scripted readRawUs() results; the brute force keeps
+ * the same millimeter samples (converted with the same Q16 scale) and recomputes count,
+ * mean, sample variance (double, two-pass), min and max of the last N after every read.
+ *
+ * 1) Cross-check: 20000 reads for N = 2, 16 and 128 (xorshift32, fixed seed): distances
+ *    20..4000 mm, 1 read in 10 a timeout, a reset() every 7919 reads.
+ * 2) Drift: 5 million reads, N = 16, alternating 50000 reads spread over 20..4000 mm
+ *    with 50000 reads of a still target at 3 m (true variance 0, so any residue shows).
+ *    Checked against the brute force every 1000 reads; the sliding float Welford update
+ *    this class used before runs beside it for comparison. Errors are relative, or in
+ *    units of 1e-3 mm^2 when the true variance is below that.
+ *
+ * Exit status 1 if min/max/count differ, or if mean or variance are off by more than
+ * float rounding (relative 1e-5, or 1e-3 mm^2 near zero).
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "hcsr04_stats.hpp"
+
+/* ================================== Model ================================== */
+
+static uint32_t s_rng = 0x2545F491UL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+/* readRawUs() returns whatever the test sets next. */
+class FeedSensor : public IHCSR04
+{
+public:
+  FeedSensor(void) :
+    IHCSR04(9U, 8U),
+    m_status(HCSR04_OK),
+    m_echo_us(0UL)
+  {
+  }
+
+  void next(HCSR04_Status status, unsigned long echo_us)
+  {
+    m_status = status;
+    m_echo_us = echo_us;
+  }
+
+  /* Same conversion as the decorator (default sound speed on both). */
+  uint16_t toMm(unsigned long echo_us) const
+  {
+    uint16_t mm = 0U;
+    (void)timeUsToMm_(echo_us, mm);
+    return mm;
+  }
+
+  HCSR04_Status begin(void) { return HCSR04_OK; }
+
+  HCSR04_Status read(float &out_cm)
+  {
+    out_cm = 0.0F;
+    return HCSR04_ERR_NOT_READY;
+  }
+
+  HCSR04_Status readRawUs(unsigned long &out_echo_us)
+  {
+    if (m_status == HCSR04_OK)
+    {
+      out_echo_us = m_echo_us;
+    }
+    return m_status;
+  }
+
+private:
+  HCSR04_Status m_status;
+  unsigned long m_echo_us;
+};
+
+/* Last N samples, oldest first, statistics from scratch. */
+template <uint8_t N>
+class BruteWindow
+{
+public:
+  BruteWindow(void) : m_count(0U) {}
+
+  void clear(void) { m_count = 0U; }
+
+  void push(uint16_t mm)
+  {
+    if (m_count < N)
+    {
+      m_count++;
+    }
+    else
+    {
+      for (uint8_t i = 1U; i < N; i++)
+      {
+        m_mm[i - 1U] = m_mm[i];
+      }
+    }
+    m_mm[m_count - 1U] = mm;
+  }
+
+  uint8_t count(void) const { return m_count; }
+
+  void stats(double &mean, double &var, uint16_t &mn, uint16_t &mx) const
+  {
+    double sum = 0.0;
+    mn = 0xFFFFU;
+    mx = 0U;
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      sum += m_mm[i];
+      mn = (m_mm[i] < mn) ? m_mm[i] : mn;
+      mx = (m_mm[i] > mx) ? m_mm[i] : mx;
+    }
+    mean = sum / m_count;
+    double m2 = 0.0;
+    for (uint8_t i = 0U; i < m_count; i++)
+    {
+      m2 += (m_mm[i] - mean) * (m_mm[i] - mean);
+    }
+    var = (m_count > 1U) ? (m2 / (m_count - 1U)) : 0.0;
+  }
+
+private:
+  uint16_t m_mm[N];
+  uint8_t  m_count;
+};
+
+/* The sliding float Welford update HCSR04_Stats used before (reference for the drift). */
+template <uint8_t N>
+class FloatWelford
+{
+public:
+  FloatWelford(void) : m_sum(0UL), m_mean(0.0F), m_m2(0.0F), m_head(0U), m_count(0U) {}
+
+  void push(uint16_t mm)
+  {
+    const float x_new = static_cast<float>(mm);
+    if (m_count < N)
+    {
+      m_count++;
+      m_sum += mm;
+      const float delta = x_new - m_mean;
+      m_mean = static_cast<float>(m_sum) / static_cast<float>(m_count);
+      m_m2 += delta * (x_new - m_mean);
+    }
+    else
+    {
+      const uint16_t oldest = m_ring[m_head];
+      const float x_old = static_cast<float>(oldest);
+      const float mean_old = m_mean;
+      m_sum = (m_sum - oldest) + mm;
+      m_mean = static_cast<float>(m_sum) / static_cast<float>(N);
+      m_m2 += (x_new - x_old) * ((x_new - m_mean) + (x_old - mean_old));
+    }
+    if (m_m2 < 0.0F)
+    {
+      m_m2 = 0.0F;
+    }
+    m_ring[m_head] = mm;
+    m_head = (m_head == (N - 1U)) ? 0U : static_cast<uint8_t>(m_head + 1U);
+  }
+
+  double variance(void) const { return (m_count > 1U) ? (m_m2 / static_cast<float>(m_count - 1U)) : 0.0; }
+
+private:
+  uint16_t      m_ring[N];
+  unsigned long m_sum;
+  float         m_mean;
+  float         m_m2;
+  uint8_t       m_head;
+  uint8_t       m_count;
+};
+
+/* Relative error, with an absolute floor near zero. */
+static double relError(double got, double want, double floor_abs)
+{
+  const double diff = fabs(got - want);
+  return (fabs(want) > floor_abs) ? (diff / fabs(want)) : (diff / floor_abs);
+}
+
+struct CheckResult
+{
+  unsigned long exact_fail;   /* count/min/max mismatches */
+  double        max_mean_err; /* relative */
+  double        max_var_err;  /* relative, 1e-3 mm^2 floor */
+  double        old_var_err;  /* float Welford, worst */
+  double        old_var_last; /* float Welford, at the last check */
+};
+
+/* Compare one snapshot with the brute force; exact mismatches and worst errors go to res. */
+template <uint8_t N>
+static void compare(const HCSR04_Stats<N> &stats, const BruteWindow<N> &brute, CheckResult &res)
+{
+  HCSR04_WindowStats snap = { 0U, 0.0F, 0.0F, 0U, 0U };
+  const bool valid = stats.getStats(snap);
+  if (brute.count() == 0U)
+  {
+    res.exact_fail += valid ? 1UL : 0UL;
+  }
+  else
+  {
+    double mean = 0.0;
+    double var = 0.0;
+    uint16_t mn = 0U;
+    uint16_t mx = 0U;
+    brute.stats(mean, var, mn, mx);
+    if (!valid || (snap.count != brute.count()) || (snap.min_mm != mn) || (snap.max_mm != mx))
+    {
+      res.exact_fail++;
+    }
+    else
+    {
+      const double e_mean = relError(snap.mean_mm, mean, 1.0);
+      const double e_var = relError(snap.variance_mm2, var, 1.0e-3);
+      res.max_mean_err = (e_mean > res.max_mean_err) ? e_mean : res.max_mean_err;
+      res.max_var_err = (e_var > res.max_var_err) ? e_var : res.max_var_err;
+    }
+  }
+}
+
+template <uint8_t N>
+static CheckResult crossCheck(unsigned long reads)
+{
+  FeedSensor feed;
+  HCSR04_Stats<N> stats(feed);
+  BruteWindow<N> brute;
+  (void)stats.begin();
+  CheckResult res = { 0UL, 0.0, 0.0, 0.0, 0.0 };
+
+  for (unsigned long k = 1UL; k <= reads; k++)
+  {
+    if ((k % 7919UL) == 0UL)
+    {
+      stats.reset();
+      brute.clear();
+    }
+    const uint32_t r = nextRandom();
+    const bool timeout = ((r % 10UL) == 3UL);
+    const unsigned long echo_us = 117UL + (nextRandom() % 23200UL);  /* ~20..4000 mm */
+    feed.next(timeout ? HCSR04_ERR_TIMEOUT_ECHO_END : HCSR04_OK, echo_us);
+    unsigned long out_us = 0UL;
+    const HCSR04_Status st = stats.readRawUs(out_us);
+    if (st != (timeout ? HCSR04_ERR_TIMEOUT_ECHO_END : HCSR04_OK))
+    {
+      res.exact_fail++;
+    }
+    if (!timeout)
+    {
+      brute.push(feed.toMm(echo_us));
+    }
+    compare<N>(stats, brute, res);
+  }
+  return res;
+}
+
+/* Phases of DRIFT_PHASE reads: a spread of 20..4000 mm (a crowded scene), then a still
+   target at 3 m (the true variance drops to 0). */
+static const unsigned long DRIFT_PHASE = 50000UL;
+
+static CheckResult driftRun(unsigned long reads)
+{
+  FeedSensor feed;
+  HCSR04_Stats<16> stats(feed);
+  BruteWindow<16> brute;
+  FloatWelford<16> old_welford;
+  (void)stats.begin();
+  CheckResult res = { 0UL, 0.0, 0.0, 0.0, 0.0 };
+
+  for (unsigned long k = 1UL; k <= reads; k++)
+  {
+    const bool still = (((k - 1UL) / DRIFT_PHASE) % 2UL) == 1UL;
+    const unsigned long echo_us = still ? 17500UL : (117UL + (nextRandom() % 23200UL));
+    feed.next(HCSR04_OK, echo_us);
+    unsigned long out_us = 0UL;
+    (void)stats.readRawUs(out_us);
+    const uint16_t mm = feed.toMm(echo_us);
+    brute.push(mm);
+    old_welford.push(mm);
+
+    if ((k % 1000UL) == 0UL)
+    {
+      compare<16>(stats, brute, res);
+      double mean = 0.0;
+      double var = 0.0;
+      uint16_t mn = 0U;
+      uint16_t mx = 0U;
+      brute.stats(mean, var, mn, mx);
+      res.old_var_last = relError(old_welford.variance(), var, 1.0e-3);
+      res.old_var_err = (res.old_var_last > res.old_var_err) ? res.old_var_last : res.old_var_err;
+    }
+  }
+  return res;
+}
+
+static bool judge(const CheckResult &res)
+{
+  return (res.exact_fail == 0UL) && (res.max_mean_err <= 1.0e-5) && (res.max_var_err <= 1.0e-5);
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  printf("1) HCSR04_Stats<N> vs window recomputed from scratch, 20000 reads, 1 in 10 a timeout\n\n");
+  printf("    N | count/min/max mismatches | Worst mean error | Worst variance error\n");
+  printf("  ----+--------------------------+------------------+---------------------\n");
+  bool ok = true;
+  const CheckResult r2 = crossCheck<2>(20000UL);
+  const CheckResult r16 = crossCheck<16>(20000UL);
+  const CheckResult r128 = crossCheck<128>(20000UL);
+  const CheckResult *rows[] = { &r2, &r16, &r128 };
+  static const unsigned NS[] = { 2U, 16U, 128U };
+  for (uint8_t i = 0U; i < 3U; i++)
+  {
+    printf("  %3u | %24lu | %12.1e     | %12.1e\n", NS[i], rows[i]->exact_fail, rows[i]->max_mean_err,
+           rows[i]->max_var_err);
+    ok = judge(*rows[i]) && ok;
+  }
+
+  static const unsigned long DRIFT_READS = 5000000UL;
+  printf("\n2) Drift: %lu reads, N = 16, %lu spread over 20..4000 mm / %lu still at 3 m, checked every 1000\n\n",
+         DRIFT_READS, DRIFT_PHASE, DRIFT_PHASE);
+  const CheckResult drift = driftRun(DRIFT_READS);
+  printf("  Variance                       | Worst relative error | At the end\n");
+  printf("  -------------------------------+----------------------+-----------\n");
+  printf("  HCSR04_Stats (integer sums)    | %12.1e         |\n", drift.max_var_err);
+  printf("  Sliding float Welford (before) | %12.1e         | %9.1e\n", drift.old_var_err, drift.old_var_last);
+  ok = judge(drift) && ok;
+
+  printf("\n%s\n", ok ? "PASS: statistics match the window, no drift" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file sim_temp_comp.cpp
+ * @brief Temperature sweep of HCSR04_TempCompensator driving a real HCSR04_Polling.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * Two HCSR04_Polling drivers face the same 200 cm target through HostSr04 modules:
+ * one is compensated by HCSR04_TempCompensator, the other keeps the fixed 343 m/s.
+ * Air goes from -15 to +40.5 degC at 1 degC/min (RH 50 %); both fire once per second.
+ * The on-chip sensor is modelled as ADC = 292 + 0.93 LSB/degC * (T_die - 25), rounded
+ * to 1 LSB; conversions complete one loop pass (1 ms) after update() starts them.
+ *
+ * The true sound speed comes from HCSR04_Air::speedMs(), the model behind the
+ * compensator's table, so the sweep measures ADC quantization, filter lag and table
+ * interpolation, not the accuracy of the air model itself.
+ *
+ * Columns: error of the fixed driver; of the compensated one with the die at ambient
+ * (calibrated sensor); of the compensated one with the die 10 degC warm and left
+ * uncalibrated (the worst case named in hcsr04_temp_comp.hpp).
+ *
+ * A third sweep interleaves a sketch analogRead(A0) with every fourth temperature
+ * conversion: ADMUX is rewritten (AVcc, channel 0) while the conversion runs and the
+ * result is the foreign reading (ADC 700). The ISR must drop those samples and update()
+ * must restore the temperature setting, so the error stays as in the clean sweep.
+ *
+ * Exit status 1 if the calibrated compensated error exceeds 1 cm anywhere from -10 degC
+ * on (with or without interleaved analogRead()), or if it does not beat the fixed
+ * driver at the ends of the sweep.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "hcsr04_polling.hpp"
+#include "hcsr04_temp_comp.hpp"
+#include "host_sr04.hpp"
+
+ISR(ADC_vect);
+
+/* ================================== Model ================================== */
+
+static const double TARGET_MM = 2000.0;
+static const double RH = 0.5;
+static const int TABLE_C[] = { -10, 0, 10, 20, 30, 40 };
+static const unsigned TABLE_ROWS = sizeof(TABLE_C) / sizeof(TABLE_C[0]);
+
+static HostSr04 *s_modules[2];
+
+static void serviceModules(void)
+{
+  for (unsigned i = 0U; i < 2U; i++)
+  {
+    s_modules[i]->service();
+  }
+}
+
+struct SweepResult
+{
+  double fixed_cm[TABLE_ROWS];
+  double comp_cm[TABLE_ROWS];
+  double worst_comp_cm;      /* largest |compensated error| from -10 degC on */
+};
+
+/* One sweep; die_offset_c is the die temperature above ambient. */
+static void runSweep(double die_offset_c, bool interleave_analog_read, SweepResult &out)
+{
+  unsigned long conversions = 0UL;
+  HCSR04_Polling comp(9U, 8U);
+  HCSR04_Polling fixed(7U, 6U);
+  HostSr04 comp_module(comp, 8U);
+  HostSr04 fixed_module(fixed, 6U);
+  HCSR04_TempCompensator compensator(comp, 50U);
+
+  s_modules[0] = &comp_module;
+  s_modules[1] = &fixed_module;
+  host_on_micros = serviceModules;
+  host_micros_step = 1UL;
+  host_now_us = 1000000UL;
+
+  (void)comp.begin();
+  (void)fixed.begin();
+  (void)compensator.begin();
+
+  const unsigned long start_us = host_now_us;
+  unsigned long next_shot_us = start_us;
+  unsigned row = 0U;
+  out.worst_comp_cm = 0.0;
+  for (unsigned r = 0U; r < TABLE_ROWS; r++)
+  {
+    out.fixed_cm[r] = 0.0;
+    out.comp_cm[r] = 0.0;
+  }
+
+  for (;;)
+  {
+    const double minutes = static_cast<double>(host_now_us - start_us) / 60.0e6;
+    const double air_c = -15.0 + minutes;
+    if (air_c > 40.5)
+    {
+      break;
+    }
+
+    /* ADC conversion started by the previous update() completes now. */
+    if ((ADCSRA & _BV(ADSC)) != 0U)
+    {
+      const double adc = 292.0 + (0.93 * ((air_c + die_offset_c) - 25.0));
+      ADC = static_cast<uint16_t>(lround(adc));
+      conversions++;
+      if (interleave_analog_read && ((conversions % 4UL) == 0UL))
+      {
+        /* analogRead(A0) as the core does it: ADMUX rewritten, foreign result. */
+        ADMUX = static_cast<uint8_t>(_BV(REFS0));
+        ADC = 700U;
+      }
+      ADCSRA &= static_cast<uint8_t>(~_BV(ADSC));
+      ADC_vect();
+    }
+    (void)compensator.update();
+
+    if (host_now_us >= next_shot_us)
+    {
+      const double round_trip_us = (2.0 * TARGET_MM) / (HCSR04_Air::speedMs(air_c, RH) / 1000.0);
+      comp_module.setReflector(0U, static_cast<unsigned long>(lround(round_trip_us)));
+      fixed_module.setReflector(0U, static_cast<unsigned long>(lround(round_trip_us)));
+
+      uint16_t comp_mm = 0U;
+      uint16_t fixed_mm = 0U;
+      const HCSR04_Status s1 = comp.readMm(comp_mm);
+      const HCSR04_Status s2 = fixed.readMm(fixed_mm);
+      if ((s1 == HCSR04_OK) && (s2 == HCSR04_OK))
+      {
+        const double comp_cm = (static_cast<double>(comp_mm) - TARGET_MM) / 10.0;
+        const double fixed_cm = (static_cast<double>(fixed_mm) - TARGET_MM) / 10.0;
+        if ((air_c >= -10.0) && (fabs(comp_cm) > out.worst_comp_cm))
+        {
+          out.worst_comp_cm = fabs(comp_cm);
+        }
+        if ((row < TABLE_ROWS) && (air_c >= static_cast<double>(TABLE_C[row])))
+        {
+          out.fixed_cm[row] = fixed_cm;
+          out.comp_cm[row] = comp_cm;
+          row++;
+        }
+      }
+      next_shot_us += 1000000UL;
+    }
+
+    host_now_us += 1000UL;
+  }
+
+  host_on_micros = 0;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  SweepResult calibrated;
+  SweepResult warm_die;
+  SweepResult shared_adc;
+  runSweep(0.0, false, calibrated);
+  runSweep(10.0, false, warm_die);
+  runSweep(0.0, true, shared_adc);
+
+  printf("Temperature sweep, 200 cm target, RH 50 %%, 1 degC/min\n\n");
+  printf("  Air temp | Error, fixed 343 m/s | Error, compensated | Compensated, die +10 C\n");
+  printf("  ---------+----------------------+--------------------+-----------------------\n");
+  for (unsigned r = 0U; r < TABLE_ROWS; r++)
+  {
+    printf("   %+4d C  |       %+5.1f cm       |      %+5.1f cm      |      %+5.1f cm\n",
+           TABLE_C[r], calibrated.fixed_cm[r], calibrated.comp_cm[r], warm_die.comp_cm[r]);
+  }
+  printf("\n  Largest compensated error from -10 C on: %.1f cm\n", calibrated.worst_comp_cm);
+  printf("  Same, analogRead(A0) during every 4th conversion: %.1f cm\n", shared_adc.worst_comp_cm);
+
+  const bool ok = (calibrated.worst_comp_cm <= 1.0) && (shared_adc.worst_comp_cm <= 1.0) &&
+                  (fabs(calibrated.comp_cm[0]) < fabs(calibrated.fixed_cm[0])) &&
+                  (fabs(calibrated.comp_cm[TABLE_ROWS - 1U]) < fabs(calibrated.fixed_cm[TABLE_ROWS - 1U]));
+  printf("\n%s\n", ok ? "PASS: compensation within 1 cm" : "FAIL");
+  return ok ? 0 : 1;
+}
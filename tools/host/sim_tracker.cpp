@@ -0,0 +1,165 @@
+/**
+ * @file sim_tracker.cpp
+ * @brief HCSR04_Tracker convergence on an approaching target with noise and timeouts.
+ * @version 1.0
+ * @date 2025-10-28
+ *
+ * A target starts at 3000 mm and approaches at 0.5 m/s for 4.8 s (down to 600 mm).
+ * Shots every 60 ms plus 0..3 ms jitter; each measurement is the true distance at the
+ * shot, rounded to 1 mm, plus uniform noise (xorshift32, fixed seed). update() gets
+ * HCSR04_ERR_TIMEOUT_ECHO_END for the shots scripted as timeouts:
+ * - none;
+ * - 1 shot in 7;
+ * - 1 in 7 plus a dropout of 6 shots at 2 s (coasting, the track must survive);
+ * - 1 in 7 plus a dropout of 15 shots at 2 s (more than HCSR04_TRACK_MAX_COAST: the
+ *   track must be dropped, then taken up again by the next measurement).
+ * Errors are taken on measured shots from 1.5 s on (the filter has settled) and, for
+ * the long dropout, outside the 1.5 s after re-acquisition.
+ *
+ * Exit status 1 if, with +-10 mm noise, the velocity is off by more than 100 mm/s or
+ * the distance RMS error exceeds 10 mm on any row, if a short dropout drops the track,
+ * or if the long one does not (or the track is not back on the next measurement).
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "hcsr04_tracker.hpp"
+
+/* ================================== Model ================================== */
+
+static const double START_MM = 3000.0;
+static const double SPEED_MM_S = -500.0;
+static const unsigned long RUN_US = 4800000UL;
+static const unsigned long PERIOD_US = 60000UL;
+static const unsigned long SETTLE_US = 1500000UL;
+static const unsigned long DROPOUT_AT_US = 2000000UL;
+
+static uint32_t s_rng = 0x1234567UL;
+
+static uint32_t nextRandom(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return x;
+}
+
+/* Uniform in [-1, 1]. */
+static double noiseUnit(void)
+{
+  return ((static_cast<double>(nextRandom()) / 4294967295.0) * 2.0) - 1.0;
+}
+
+struct TrackRow
+{
+  double        rms_mm;       /* distance, measured shots after settling */
+  double        max_mm;
+  double        max_vel_err;  /* |v - SPEED_MM_S| after settling */
+  unsigned long measured;
+  unsigned long timeouts;
+  unsigned      drops;        /* update() returned NOT_READY on a coast */
+  bool          back_at_once; /* first measurement after a drop re-initialized the track */
+};
+
+static TrackRow runTrack(double noise_mm, bool periodic_timeouts, unsigned dropout)
+{
+  HCSR04_Tracker tracker;
+  s_rng = 0x1234567UL;
+  TrackRow row = { 0.0, 0.0, 0.0, 0UL, 0UL, 0U, true };
+  double sum_sq = 0.0;
+  unsigned long samples = 0UL;
+  unsigned long reacquired_us = 0UL;
+  bool dropped = false;
+  unsigned left_out = 0U;
+  unsigned long shot = 0UL;
+
+  for (unsigned long t_us = 1000UL; t_us < RUN_US; t_us += PERIOD_US + (nextRandom() % 3000UL))
+  {
+    shot++;
+    const double true_mm = START_MM + ((SPEED_MM_S * static_cast<double>(t_us)) / 1.0e6);
+    const double noise = noise_mm * noiseUnit();
+    if ((dropout != 0U) && (left_out == 0U) && (t_us >= DROPOUT_AT_US) && (t_us < (DROPOUT_AT_US + PERIOD_US)))
+    {
+      left_out = dropout;
+    }
+    const bool timeout = (left_out != 0U) || (periodic_timeouts && ((shot % 7UL) == 0UL));
+    left_out = (left_out != 0U) ? (left_out - 1U) : 0U;
+
+    if (timeout)
+    {
+      row.timeouts++;
+      if ((tracker.update(HCSR04_ERR_TIMEOUT_ECHO_END, 0U, t_us) == HCSR04_ERR_NOT_READY) && !dropped)
+      {
+        row.drops++;
+        dropped = true;
+      }
+    }
+    else
+    {
+      const uint16_t z_mm = static_cast<uint16_t>(lround(true_mm + noise));
+      const HCSR04_Status st = tracker.update(HCSR04_OK, z_mm, t_us);
+      HCSR04_TrackState s;
+      const bool valid = tracker.getState(s);
+      if (dropped)
+      {
+        row.back_at_once = row.back_at_once && (st == HCSR04_OK) && valid && (s.velocity_mm_s == 0);
+        reacquired_us = t_us;
+        dropped = false;
+      }
+      row.measured++;
+      const bool settled = (t_us >= SETTLE_US) && ((reacquired_us == 0UL) || (t_us >= (reacquired_us + SETTLE_US)));
+      if (valid && settled)
+      {
+        const double e = fabs(static_cast<double>(s.distance_mm) - true_mm);
+        const double ev = fabs(static_cast<double>(s.velocity_mm_s) - SPEED_MM_S);
+        sum_sq += e * e;
+        samples++;
+        row.max_mm = (e > row.max_mm) ? e : row.max_mm;
+        row.max_vel_err = (ev > row.max_vel_err) ? ev : row.max_vel_err;
+      }
+    }
+  }
+  row.rms_mm = (samples != 0UL) ? sqrt(sum_sq / static_cast<double>(samples)) : 1.0e9;
+  return row;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const struct
+  {
+    const char *label;
+    double      noise_mm;
+    bool        periodic;
+    unsigned    dropout;
+    unsigned    drops;     /* expected */
+  } CASES[] = {
+    { "none",                     0.0, false,  0U, 0U },
+    { "none",                    10.0, false,  0U, 0U },
+    { "1 in 7",                  10.0, true,   0U, 0U },
+    { "1 in 7 + 6 in a row",     10.0, true,   6U, 0U },
+    { "1 in 7 + 15 in a row",    10.0, true,  15U, 1U },
+  };
+
+  printf("Target 3000 -> 600 mm at 0.5 m/s, shots every 60..63 ms, errors from 1.5 s on\n\n");
+  printf("  Timeouts              | Noise   | Measured / timeouts | RMS / max dist. err | Max vel. err | Drops\n");
+  printf("  ----------------------+---------+---------------------+---------------------+--------------+------\n");
+  bool ok = true;
+  for (size_t c = 0U; c < (sizeof(CASES) / sizeof(CASES[0])); c++)
+  {
+    const TrackRow row = runTrack(CASES[c].noise_mm, CASES[c].periodic, CASES[c].dropout);
+    printf("  %-21s | +-%2.0f mm | %8lu / %-8lu | %5.1f / %5.1f mm    | %6.0f mm/s  | %u%s\n", CASES[c].label,
+           CASES[c].noise_mm, row.measured, row.timeouts, row.rms_mm, row.max_mm, row.max_vel_err, row.drops,
+           row.back_at_once ? "" : " (not back)");
+    if ((row.rms_mm > 10.0) || (row.max_vel_err > 100.0) || (row.drops != CASES[c].drops) || !row.back_at_once)
+    {
+      ok = false;
+    }
+  }
+
+  printf("\n%s\n", ok ? "PASS: within 10 mm RMS and 100 mm/s, track kept through short dropouts" : "FAIL");
+  return ok ? 0 : 1;
+}
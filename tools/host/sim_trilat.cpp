@@ -0,0 +1,161 @@
+/**
+ * @file sim_trilat.cpp
+ * @brief Localization error of HCSR04_Trilat over a target grid, plus an isqrt32() check.
+ * @version 1.0
+ * @date 2025-10-27
+ *
+ * fuse() is fed the true ranges of every target of a 200 x 200 grid (x -1000..1000 mm
+ * step 10, y 100..3000 mm step 14.5), rounded to 1 mm like the drivers' readMm(),
+ * optionally with uniform noise (xorshift32, fixed seed). Targets beyond
+ * HCSR04_TRILAT_MAX_MM from any sensor are skipped. isqrt32() is compared with the
+ * floor square root on every 7th value below 2e7 and at 0xFFFFFFFF.
+ *
+ * Exit status 1 on any isqrt32() mismatch, on a fuse() failure without noise, or on a
+ * noise-free RMS error above 1 cm.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "hcsr04_trilat.hpp"
+
+/* ================================== Model ================================== */
+
+static uint32_t s_rng = 1UL;
+
+/* Uniform in [-1, 1]. */
+static double noiseUnit(void)
+{
+  uint32_t x = s_rng;
+  x ^= (x << 13);
+  x ^= (x >> 17);
+  x ^= (x << 5);
+  s_rng = x;
+  return ((static_cast<double>(x) / 4294967295.0) * 2.0) - 1.0;
+}
+
+struct GridRow
+{
+  double rms_x_mm;
+  double rms_y_mm;
+  double max_x_mm;
+  double max_y_mm;
+  unsigned max_residual_mm;
+  unsigned long fused;
+  unsigned long failed;
+};
+
+static GridRow runGrid(const int16_t *xs, uint8_t n, double noise_mm)
+{
+  HCSR04_Trilat trilat;
+  (void)trilat.setGeometry(xs, n);
+  s_rng = 1UL;
+
+  GridRow row = { 0.0, 0.0, 0.0, 0.0, 0U, 0UL, 0UL };
+  double sum_x = 0.0;
+  double sum_y = 0.0;
+  for (int gx = 0; gx < 200; gx++)
+  {
+    for (int gy = 0; gy < 200; gy++)
+    {
+      const double tx = -1000.0 + (10.0 * gx);
+      const double ty = 100.0 + (14.5 * gy);
+      uint16_t d_mm[HCSR04_TRILAT_MAX_SENSORS];
+      bool in_range = true;
+      for (uint8_t i = 0U; i < n; i++)
+      {
+        const double dx = tx - xs[i];
+        const double r = sqrt((dx * dx) + (ty * ty)) + (noise_mm * noiseUnit());
+        if (r > static_cast<double>(HCSR04_TRILAT_MAX_MM))
+        {
+          in_range = false;
+        }
+        d_mm[i] = static_cast<uint16_t>(lround(r));
+      }
+      if (in_range)
+      {
+        HCSR04_Position p;
+        if (trilat.fuse(d_mm, 0, p) == HCSR04_OK)
+        {
+          const double ex = fabs(p.x_mm - tx);
+          const double ey = fabs(p.y_mm - ty);
+          row.max_x_mm = (ex > row.max_x_mm) ? ex : row.max_x_mm;
+          row.max_y_mm = (ey > row.max_y_mm) ? ey : row.max_y_mm;
+          row.max_residual_mm = (p.residual_mm > row.max_residual_mm) ? p.residual_mm : row.max_residual_mm;
+          sum_x += ex * ex;
+          sum_y += ey * ey;
+          row.fused++;
+        }
+        else
+        {
+          row.failed++;
+        }
+      }
+    }
+  }
+  row.rms_x_mm = sqrt(sum_x / static_cast<double>(row.fused));
+  row.rms_y_mm = sqrt(sum_y / static_cast<double>(row.fused));
+  return row;
+}
+
+static bool checkIsqrt(void)
+{
+  bool ok = true;
+  for (uint32_t v = 0UL; v < 20000000UL; v += 7UL)
+  {
+    const uint64_t r = HCSR04_Trilat::isqrt32(v);
+    if (((r * r) > v) || (((r + 1U) * (r + 1U)) <= v))
+    {
+      printf("  isqrt32(%lu) = %lu is wrong\n", static_cast<unsigned long>(v), static_cast<unsigned long>(r));
+      ok = false;
+      break;
+    }
+  }
+  if (HCSR04_Trilat::isqrt32(0xFFFFFFFFUL) != 65535UL)
+  {
+    printf("  isqrt32(0xFFFFFFFF) != 65535\n");
+    ok = false;
+  }
+  return ok;
+}
+
+/* ================================== main =================================== */
+
+int main(void)
+{
+  static const int16_t G2[] = { -100, 100 };
+  static const int16_t G3[] = { -150, 0, 150 };
+  static const int16_t G4[] = { -300, -100, 100, 300 };
+  static const struct
+  {
+    const char    *label;
+    const int16_t *xs;
+    uint8_t        n;
+    double         noise_mm;
+  } CASES[] = {
+    { "-100, 100",            G2, 2U, 0.0 },
+    { "-150, 0, 150",         G3, 3U, 0.0 },
+    { "-300, -100, 100, 300", G4, 4U, 0.0 },
+    { "-150, 0, 150",         G3, 3U, 5.0 },
+  };
+
+  bool ok = checkIsqrt();
+  printf("isqrt32(): %s\n\n", ok ? "exact" : "MISMATCH");
+
+  printf("200 x 200 grid, x -1000..1000 mm, y 100..3000 mm, ranges rounded to 1 mm\n\n");
+  printf("  Sensors at (mm)      | Noise   | RMS x / y (mm) | Max x / y (mm) | Max residual | Fused / failed\n");
+  printf("  ---------------------+---------+----------------+----------------+--------------+---------------\n");
+  for (size_t c = 0U; c < (sizeof(CASES) / sizeof(CASES[0])); c++)
+  {
+    const GridRow row = runGrid(CASES[c].xs, CASES[c].n, CASES[c].noise_mm);
+    printf("  %-20s | +-%2.0f mm | %5.1f / %5.1f  | %5.0f / %5.0f  | %6u mm    | %lu / %lu\n", CASES[c].label,
+           CASES[c].noise_mm, row.rms_x_mm, row.rms_y_mm, row.max_x_mm, row.max_y_mm, row.max_residual_mm,
+           row.fused, row.failed);
+    if ((CASES[c].noise_mm == 0.0) && ((row.failed != 0UL) || (row.rms_x_mm > 10.0) || (row.rms_y_mm > 10.0)))
+    {
+      ok = false;
+    }
+  }
+
+  printf("\n%s\n", ok ? "PASS: isqrt32 exact, noise-free fusion within 1 cm RMS" : "FAIL");
+  return ok ? 0 : 1;
+}